@@ -23,6 +23,8 @@
  */
 #include <stdint.h>
 #include "../inc/tm4c123gh6pm.h"
+#include "RamFunc.h"
+#include "ADCT0ATrigger.h"
 #define NVIC_EN0_INT17          0x00020000  // Interrupt 17 enable
 
 #define TIMER_CFG_16_BIT        0x00000004  // 16-bit timer configuration,
@@ -56,6 +58,7 @@
 #define ADC_SSFIFO3_DATA_M      0x00000FFF  // Conversion Result Data mask
 #define ADC_PC_SR_M             0x0000000F  // ADC Sample Rate
 #define ADC_PC_SR_125K          0x00000001  // 125 ksps
+#define ADC_PC_SR_1M            0x00000007  // 1 Msps
 #define SYSCTL_RCGCGPIO_R4      0x00000010  // GPIO Port E Run Mode Clock
                                             // Gating Control
 #define SYSCTL_RCGCGPIO_R3      0x00000008  // GPIO Port D Run Mode Clock
@@ -68,43 +71,21 @@ void EnableInterrupts(void);  // Enable interrupts
 long StartCritical (void);    // previous I bit, disable interrupts
 void EndCritical(long sr);    // restore I bit to previous value
 void WaitForInterrupt(void);  // low power mode
+uint32_t OS_Unprivileged(void); // in osasm.s, 1 if caller must use SVC
+unsigned long OS_Time(void);      // in os.h, 12.5ns units
+int SVC_ADCInit(unsigned int channelNum, uint32_t freq, void(*task)(uint32_t hi));
+int SVC_ADCCollect(uint32_t channelNum, uint32_t fs, uint16_t *buffer, uint32_t numberOfSamples);
+int SVC_ADCStop(void);
+int SVC_ADCArmComparator(uint32_t comp);
 
-// There are many choices to make when using the ADC, and many
-// different combinations of settings will all do basically the
-// same thing.  For simplicity, this function makes some choices
-// for you.  When calling this function, be sure that it does
-// not conflict with any other software that may be running on
-// the microcontroller.  Particularly, ADC0 sample sequencer 3
-// is used here because it only takes one sample, and only one
-// sample is absolutely needed.  Sample sequencer 3 generates a
-// raw interrupt when the conversion is complete, and it is then
-// promoted to an ADC0 controller interrupt.  Hardware Timer0A
-// triggers the ADC0 conversion at the programmed interval, and
-// software handles the interrupt to process the measurement
-// when it is complete.
-//
-// A simpler approach would be to use software to trigger the
-// ADC0 conversion, wait for it to complete, and then process the
-// measurement.
-//
-// This initialization function sets up the ADC according to the
-// following parameters.  Any parameters not explicitly listed
-// below are not modified:
-// Timer0A: enabled
-// Mode: 32-bit, down counting
-// One-shot or periodic: periodic
-// Interval value: programmable using 32-bit period
-// Sample time is busPeriod*period
-// Max sample rate: <=125,000 samples/second
-// Sequencer 0 priority: 1st (highest)
-// Sequencer 1 priority: 2nd
-// Sequencer 2 priority: 3rd
-// Sequencer 3 priority: 4th (lowest)
-// SS3 triggering event: Timer0A
-// SS3 1st sample source: programmable using variable 'channelNum' [0:11]
-// SS3 interrupts: enabled and promoted to controller
-void ADC0_InitTimer0ATriggerSeq3(uint8_t channelNum, uint32_t period){
+// make one analog input pin ready for the ADC
+// Inputs:  channelNum 0 to 11, ADC_TEMPSENSOR needs no pin
+// Outputs: 1 if successful, 0 if the channel does not exist
+static int ADC_PinInit(uint8_t channelNum){
   volatile uint32_t delay;
+  if(channelNum == ADC_TEMPSENSOR){
+    return 1;
+  }
   // **** GPIO pin initialization ****
   switch(channelNum){             // 1) activate clock
     case 0:
@@ -122,7 +103,7 @@ void ADC0_InitTimer0ATriggerSeq3(uint8_t channelNum, uint32_t period){
     case 10:
     case 11:                      //    these are on GPIO_PORTB
       SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1; break;
-    default: return;              //    0 to 11 are valid channels on the LM4F120
+    default: return 0;            //    0 to 11 are valid channels on the LM4F120
   }
   delay = SYSCTL_RCGCGPIO_R;      // 2) allow time for clock to stabilize
   delay = SYSCTL_RCGCGPIO_R;
@@ -200,18 +181,86 @@ void ADC0_InitTimer0ATriggerSeq3(uint8_t channelNum, uint32_t period){
       GPIO_PORTB_AMSEL_R |= 0x20; // 6.11) enable analog functionality on PB5
       break;
   }
-  DisableInterrupts();
-  SYSCTL_RCGCADC_R |= 0x01;     // activate ADC0 
+  return 1;
+}
+
+// Timer0A triggers every enabled sequencer set to the timer event
+// Inputs:  bus cycles between triggers, 32-bit mode, so any rate
+//          from 1 Hz up and ADC_TriggerTime sees the whole count
+static void ADC_Timer0AInit(uint32_t period){
+  volatile uint32_t delay;
   SYSCTL_RCGCTIMER_R |= 0x01;   // activate timer0 
   delay = SYSCTL_RCGCTIMER_R;   // allow time to finish activating
   TIMER0_CTL_R = 0x00000000;    // disable timer0A during setup
   TIMER0_CTL_R |= 0x00000020;   // enable timer0A trigger to ADC
-  TIMER0_CFG_R = 0x04;             // configure for 16-bit timer mode
+  TIMER0_CFG_R = 0;             // configure for 32-bit timer mode
   TIMER0_TAMR_R = 0x00000002;   // configure for periodic mode, default down-count settings
   TIMER0_TAPR_R = 0;            // prescale value for trigger
   TIMER0_TAILR_R = period-1;    // start value for trigger
   TIMER0_IMR_R = 0x00000000;    // disable all interrupts
   TIMER0_CTL_R |= 0x00000001;   // enable timer0A 32-b, periodic, no interrupts
+}
+
+// ******** ADC_TriggerTime ************
+// OS_Time of the latest Timer0A trigger, which is when the ADC
+// sampled.  Timer0A counts down from TAILR and reloads at the
+// trigger, so TAILR-TAV is how long ago that was, exact to a few
+// bus cycles however late the ISR runs, as long as it is less than
+// one sample period late
+// Inputs:  none
+// Outputs: time in 12.5ns units
+RAMFUNC unsigned long ADC_TriggerTime(void){
+  long sr;
+  unsigned long now;
+  uint32_t count;
+  sr = StartCritical();
+  now = OS_Time();
+  count = TIMER0_TAV_R;
+  EndCritical(sr);
+  return now - (TIMER0_TAILR_R - count);
+}
+
+// There are many choices to make when using the ADC, and many
+// different combinations of settings will all do basically the
+// same thing.  For simplicity, this function makes some choices
+// for you.  When calling this function, be sure that it does
+// not conflict with any other software that may be running on
+// the microcontroller.  Particularly, ADC0 sample sequencer 3
+// is used here because it only takes one sample, and only one
+// sample is absolutely needed.  Sample sequencer 3 generates a
+// raw interrupt when the conversion is complete, and it is then
+// promoted to an ADC0 controller interrupt.  Hardware Timer0A
+// triggers the ADC0 conversion at the programmed interval, and
+// software handles the interrupt to process the measurement
+// when it is complete.
+//
+// A simpler approach would be to use software to trigger the
+// ADC0 conversion, wait for it to complete, and then process the
+// measurement.
+//
+// This initialization function sets up the ADC according to the
+// following parameters.  Any parameters not explicitly listed
+// below are not modified:
+// Timer0A: enabled
+// Mode: 32-bit, down counting
+// One-shot or periodic: periodic
+// Interval value: programmable using 32-bit period
+// Sample time is busPeriod*period
+// Max sample rate: <=125,000 samples/second
+// Sequencer 0 priority: 1st (highest)
+// Sequencer 1 priority: 2nd
+// Sequencer 2 priority: 3rd
+// Sequencer 3 priority: 4th (lowest)
+// SS3 triggering event: Timer0A
+// SS3 1st sample source: programmable using variable 'channelNum' [0:11]
+// SS3 interrupts: enabled and promoted to controller
+void ADC0_InitTimer0ATriggerSeq3(uint8_t channelNum, uint32_t period){
+  if((channelNum == ADC_TEMPSENSOR) || (ADC_PinInit(channelNum) == 0)){
+    return;                       // 0 to 11 are valid channels on the LM4F120
+  }
+  DisableInterrupts();
+  SYSCTL_RCGCADC_R |= 0x01;     // activate ADC0 
+  ADC_Timer0AInit(period);
   ADC0_PC_R = 0x01;         // configure for 125K samples/sec
   ADC0_SSPRI_R = 0x3210;    // sequencer 0 is highest, sequencer 3 is lowest
   ADC0_ACTSS_R &= ~0x08;    // disable sample sequencer 3
@@ -260,11 +309,714 @@ void ADC0_InitTimer0ATriggerSeq3PD3(uint32_t period){
 volatile uint32_t ADCvalue;
 void(*ADC_ISR)(uint32_t hello);
 
-void ADC0Seq3_Handler(void){
+//------------uDMA capture----------------
+// SS3 asks the uDMA for a transfer after every conversion (IE0 set)
+// and channel 17 moves the result into memory.  The SS3 interrupt
+// mask stays clear, so the CPU is only interrupted by the uDMA done
+// signal, on the same vector, when a whole block is full.  Ping-pong mode switches
+// between the primary and the alternate control structure by itself,
+// so the next block fills while software takes the full one and
+// rearms that half for the block after.
+#define UDMA_CH_ADC0SS3   17             // encoding 0 in CHMAP2
+#define UDMA_CH_ADC1SS3   27             // encoding 1 in CHMAP3
+#define UDMA_CHCTL_DSTINC_16   0x40000000  // halfword destination increment
+#define UDMA_CHCTL_DSTINC_32   0x80000000  // word destination increment
+#define UDMA_CHCTL_DSTSIZE_16  0x10000000  // halfword destination size
+#define UDMA_CHCTL_SRCINC_NONE 0x0C000000  // source is the FIFO register
+#define UDMA_CHCTL_SRCSIZE_16  0x01000000  // halfword source size
+#define UDMA_CHCTL_ARBSIZE_1   0x00000000  // one transfer per request
+#define UDMA_CHCTL_XFERMODE_M  0x00000007
+#define UDMA_CHCTL_XFERMODE_STOP 0x00000000
+#define UDMA_CHCTL_XFERMODE_PINGPONG 0x00000003
+#define UDMA_MAXBLOCK     1024           // XFERSIZE is 10 bits
+
+// control table, 32 primary then 32 alternate structures of
+// source end, destination end, control, unused
+// the uDMA needs it on a 1024 byte boundary
+static __align(1024) uint32_t UDMA_Table[256];
+#define DMA_PRI(ch) (&UDMA_Table[4*(ch)])
+#define DMA_ALT(ch) (&UDMA_Table[4*((ch)+32)])
+
+static uint16_t *(*ADC_BlockTask)(uint16_t *full);  // 0 when not using uDMA
+static uint16_t *ADC_PriBuf;        // block being filled by the primary structure
+static uint16_t *ADC_AltBuf;        // block being filled by the alternate structure
+static uint32_t ADC_BlockSize;      // samples per block
+static uint32_t ADC_BlockControl;   // control word to rearm either half
+static unsigned long ADC_BlockStart; // ADC_TriggerTime of the first sample of the full block
+
+// point one control structure at a new block and arm it
+static void ADC_DMAArm(uint32_t *ctl, uint16_t *buf){
+  ctl[0] = (uint32_t)&ADC0_SSFIFO3_R;        // source end, fixed
+  ctl[1] = (uint32_t)&buf[ADC_BlockSize-1];  // destination end
+  ctl[2] = ADC_BlockControl;
+}
+
+// one interrupt per block, either or both halves may be done
+static void ADC_DMAHandler(void){
+  uint32_t *pri = DMA_PRI(UDMA_CH_ADC0SS3);
+  uint32_t *alt = DMA_ALT(UDMA_CH_ADC0SS3);
+  UDMA_CHIS_R = 1<<UDMA_CH_ADC0SS3;          // acknowledge channel 17
+  ADC_BlockStart = ADC_TriggerTime() - (ADC_BlockSize-1)*(TIMER0_TAILR_R+1);
+  if((pri[2]&UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP){
+    ADC_PriBuf = ADC_BlockTask(ADC_PriBuf);
+    ADC_DMAArm(pri, ADC_PriBuf);
+  }
+  if((alt[2]&UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP){
+    ADC_AltBuf = ADC_BlockTask(ADC_AltBuf);
+    ADC_DMAArm(alt, ADC_AltBuf);
+  }
+}
+
+//------------Dual ADC capture----------------
+// ADC0 SS3 and ADC1 SS3 start on the same Timer0A trigger, so the
+// two channels of a pair are converted at the same instant.  Each
+// has its own uDMA channel, 17 and 27, and both write halfwords into
+// the same block with a word increment, ADC0 into the low half and
+// ADC1 into the high half, so the block is already interleaved.
+// A block is complete when both channels have finished it.
+static void (*ADC_DualTask)(uint32_t *pairs, uint32_t count, unsigned long time);
+static uint32_t *ADC_DualBuf[2];     // ping uses primary, pong alternate
+static uint32_t ADC_DualCount;       // pairs per block
+static uint32_t ADC_DualPeriod;      // bus cycles between pairs
+static uint32_t ADC_DualControl;
+static volatile uint32_t ADC_DualDone[2];  // bit 0 ADC0 done, bit 1 ADC1 done
+
+static void ADC_DualArm(uint32_t *ctl, uint32_t adc, uint32_t *buf){
+  if(adc == 0){
+    ctl[0] = (uint32_t)&ADC0_SSFIFO3_R;
+  } else{
+    ctl[0] = (uint32_t)&ADC1_SSFIFO3_R;
+  }
+  ctl[1] = (uint32_t)&buf[ADC_DualCount-1] + 2*adc;  // end of the low or high half
+  ctl[2] = ADC_DualControl;
+}
+
+// the two ADC interrupts have the same priority, so they never
+// preempt each other and ADC_DualDone needs no lock
+static void ADC_DualHandler(uint32_t adc){
+  uint32_t ch = adc ? UDMA_CH_ADC1SS3 : UDMA_CH_ADC0SS3;
+  uint32_t *ctl[2];
+  uint32_t i;
+  ctl[0] = DMA_PRI(ch);
+  ctl[1] = DMA_ALT(ch);
+  UDMA_CHIS_R = 1<<ch;
+  for(i = 0; i < 2; i++){
+    if((ctl[i][2]&UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP){
+      ADC_DualArm(ctl[i], adc, ADC_DualBuf[i]);  // not used until the other half fills
+      ADC_DualDone[i] |= 1<<adc;
+      if(ADC_DualDone[i] == 0x03){
+        ADC_DualDone[i] = 0;
+        ADC_DualTask(ADC_DualBuf[i], ADC_DualCount,
+                     ADC_TriggerTime() - (ADC_DualCount-1)*ADC_DualPeriod);
+      }
+    }
+  }
+}
+
+RAMFUNC void ADC0Seq3_Handler(void){
   ADC0_ISC_R = 0x08;          // acknowledge ADC sequence 3 completion
+  if(ADC_DualTask){           // ADC0 half of a dual block
+    ADC_DualHandler(0);
+    return;
+  }
+  if(ADC_BlockTask){          // block complete from the uDMA
+    ADC_DMAHandler();
+    return;
+  }
   ADC_ISR(ADC0_SSFIFO3_R);  // 12-bit result
 }
 
+static void ADC_CollectHandler(void);
+RAMFUNC void ADC1Seq3_Handler(void){
+  ADC1_ISC_R = 0x08;          // acknowledge ADC1 sequence 3 completion
+  if(ADC_DualTask){           // ADC1 half of a dual block
+    ADC_DualHandler(1);
+    return;
+  }
+  ADC_CollectHandler();
+}
+
+// ******** ADC_InitDual ************
+// Sample two channels at the same instant, one on ADC0 and one on
+// ADC1, both started by Timer0A, into blocks of interleaved pairs
+// by uDMA, ping-pong.  Each pair is one word, ADC_PAIR_A/ADC_PAIR_B
+// Privileged only, call before OS_Launch
+// Inputs:  chA channel for ADC0, chB channel for ADC1, 0 to 11
+//          fs pairs per second, 1 to 1,000,000
+//          ping, pong two blocks of count pairs
+//          count pairs per block, 1 to 1024
+//          task runs in the ADC ISR when a block is full, with the
+//               block, count and the OS_Time of its first pair,
+//               and must be done with it one block time later
+// Outputs: 1 if successful, 0 on a bad channel, count or rate
+int ADC_InitDual(uint8_t chA, uint8_t chB, uint32_t fs, uint32_t *ping, uint32_t *pong,
+                 uint32_t count, void(*task)(uint32_t *pairs, uint32_t count, unsigned long time)){
+  volatile uint32_t delay;
+  if((count == 0) || (count > UDMA_MAXBLOCK) || (fs == 0) || (fs > 1000000) ||
+     (chA == ADC_TEMPSENSOR) || (chB == ADC_TEMPSENSOR) ||  // no sensor on either
+     (ADC_PinInit(chA) == 0) || (ADC_PinInit(chB) == 0)){
+    return 0;
+  }
+  SYSCTL_RCGCDMA_R |= 0x01;          // activate uDMA
+  SYSCTL_RCGCADC_R |= 0x02;          // activate ADC1
+  delay = SYSCTL_RCGCDMA_R;
+  delay = SYSCTL_RCGCADC_R;
+  UDMA_CFG_R = 0x01;                 // master enable
+  UDMA_CTLBASE_R = (uint32_t)UDMA_Table;
+  UDMA_ENACLR_R = (1<<UDMA_CH_ADC0SS3)|(1<<UDMA_CH_ADC1SS3);
+  UDMA_CHMAP2_R = (UDMA_CHMAP2_R&0xFFFFFF0F)|(0<<4);   // channel 17 is ADC0 SS3
+  UDMA_CHMAP3_R = (UDMA_CHMAP3_R&0xFFFF0FFF)|(1<<12);  // channel 27 is ADC1 SS3
+  UDMA_PRIOCLR_R = (1<<UDMA_CH_ADC0SS3)|(1<<UDMA_CH_ADC1SS3);
+  UDMA_USEBURSTCLR_R = (1<<UDMA_CH_ADC0SS3)|(1<<UDMA_CH_ADC1SS3);
+  UDMA_REQMASKCLR_R = (1<<UDMA_CH_ADC0SS3)|(1<<UDMA_CH_ADC1SS3);
+  UDMA_ALTCLR_R = (1<<UDMA_CH_ADC0SS3)|(1<<UDMA_CH_ADC1SS3);
+  ADC_DualCount = count;
+  ADC_DualPeriod = 80000000/fs;
+  ADC_DualControl = UDMA_CHCTL_DSTINC_32|UDMA_CHCTL_DSTSIZE_16|
+                    UDMA_CHCTL_SRCINC_NONE|UDMA_CHCTL_SRCSIZE_16|
+                    UDMA_CHCTL_ARBSIZE_1|((count-1)<<4)|UDMA_CHCTL_XFERMODE_PINGPONG;
+  ADC_DualBuf[0] = ping;
+  ADC_DualBuf[1] = pong;
+  ADC_DualDone[0] = 0;
+  ADC_DualDone[1] = 0;
+  ADC_DualArm(DMA_PRI(UDMA_CH_ADC0SS3), 0, ping);
+  ADC_DualArm(DMA_ALT(UDMA_CH_ADC0SS3), 0, pong);
+  ADC_DualArm(DMA_PRI(UDMA_CH_ADC1SS3), 1, ping);
+  ADC_DualArm(DMA_ALT(UDMA_CH_ADC1SS3), 1, pong);
+  ADC_DualTask = task;
+  UDMA_ENASET_R = (1<<UDMA_CH_ADC0SS3)|(1<<UDMA_CH_ADC1SS3);
+  // ADC1 first, so it is waiting when the timer starts in the ADC0 init
+  ADC1_PC_R = ADC_PC_SR_1M;
+  ADC1_SSPRI_R = 0x3210;
+  ADC1_ACTSS_R &= ~0x08;        // disable sample sequencer 3
+  ADC1_EMUX_R = (ADC1_EMUX_R&0xFFFF0FFF)+0x5000; // timer trigger event
+  ADC1_SSMUX3_R = chB;
+  ADC1_SSCTL3_R = 0x06;         // set flag and end
+  ADC1_IM_R &= ~ADC_IM_MASK3;   // uDMA done only, IE0 still requests uDMA
+  ADC1_ACTSS_R |= 0x08;         // enable sample sequencer 3
+  NVIC_PRI12_R = (NVIC_PRI12_R&0x00FFFFFF)|0x40000000; // priority 2, same as ADC0 SS3
+  NVIC_EN1_R = 1<<(51-32);      // enable interrupt 51 in NVIC
+  ADC0_InitTimer0ATriggerSeq3(chA, ADC_DualPeriod);
+  ADC0_IM_R &= ~ADC_IM_MASK3;   // same for ADC0, no interrupt per pair
+  ADC0_PC_R = ADC_PC_SR_1M;
+  return 1;
+}
+
+//------------Burst capture----------------
+// ADC_Collect runs on ADC1 SS3 and uDMA channel 27, so it can take
+// a snapshot while ADC0 keeps sampling for the DAS.  Any timer with
+// its ADC trigger enabled starts every timer triggered sequencer,
+// so the burst is paced by PWM0 generator 0 instead, which triggers
+// ADC1 each time it counts down to zero and drives no pin.
+// Captures wait in a queue in request order.  The oldest is in one
+// uDMA control structure and the next is armed in the other, so
+// ping-pong runs straight from one capture into the next with no
+// missed sample, as long as it is queued before the current one ends.
+#define ADC_COLLECTQUEUE  4          // captures waiting, including the running one
+#define PWM_0_CTL_ENABLE  0x00000001  // PWM block enable
+#define PWM_0_INTEN_TRCNTZERO 0x00000100  // trigger when the counter reaches 0
+static uint16_t *ADC_CollectBuf[ADC_COLLECTQUEUE];
+static uint32_t ADC_CollectCount[ADC_COLLECTQUEUE];
+static uint32_t ADC_CollectHead;     // oldest capture, the one being filled
+static volatile uint32_t ADC_CollectNum;  // captures in the queue, 0 when idle
+static uint32_t ADC_CollectAlt;      // 1 if the oldest uses the alternate structure
+static uint32_t ADC_CollectChannel;
+static uint32_t ADC_CollectFs;
+static void (*ADC_CollectTask)(uint16_t *buffer, uint32_t count);
+
+// point one control structure at a capture buffer and arm it
+static void ADC_CollectArm(uint32_t *ctl, uint32_t index){
+  uint32_t count = ADC_CollectCount[index];
+  ctl[0] = (uint32_t)&ADC1_SSFIFO3_R;        // source end, fixed
+  ctl[1] = (uint32_t)&ADC_CollectBuf[index][count-1];
+  ctl[2] = UDMA_CHCTL_DSTINC_16|UDMA_CHCTL_DSTSIZE_16|
+           UDMA_CHCTL_SRCINC_NONE|UDMA_CHCTL_SRCSIZE_16|
+           UDMA_CHCTL_ARBSIZE_1|((count-1)<<4)|UDMA_CHCTL_XFERMODE_PINGPONG;
+}
+
+// control structure of the oldest capture, alt 0, or the next, alt 1
+static uint32_t *ADC_CollectCtl(uint32_t alt){
+  if(ADC_CollectAlt^alt){
+    return DMA_ALT(UDMA_CH_ADC1SS3);
+  }
+  return DMA_PRI(UDMA_CH_ADC1SS3);
+}
+
+// one interrupt per finished capture, called with interrupts
+// disabled or from the ADC1 ISR
+static void ADC_CollectHandler(void){
+  uint32_t *ctl;
+  UDMA_CHIS_R = 1<<UDMA_CH_ADC1SS3;          // acknowledge channel 27
+  while(ADC_CollectNum &&
+        ((ADC_CollectCtl(0)[2]&UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP)){
+    ctl = ADC_CollectCtl(0);                 // oldest is done, retire it
+    ADC_CollectNum--;
+    ADC_CollectAlt ^= 1;
+    if(ADC_CollectNum >= 2){                 // freed structure takes the one after next
+      ADC_CollectArm(ctl, (ADC_CollectHead+2)%ADC_COLLECTQUEUE);
+    }
+    if(ADC_CollectTask){
+      ADC_CollectTask(ADC_CollectBuf[ADC_CollectHead], ADC_CollectCount[ADC_CollectHead]);
+    }
+    ADC_CollectHead = (ADC_CollectHead+1)%ADC_COLLECTQUEUE;
+  }
+  if(ADC_CollectNum == 0){
+    PWM0_0_CTL_R = 0;                        // stop triggering
+  } else if((UDMA_ENASET_R&(1<<UDMA_CH_ADC1SS3)) == 0){
+    UDMA_ENASET_R = 1<<UDMA_CH_ADC1SS3;      // next was armed just after the switch
+  }
+}
+
+// program ADC1 SS3, the uDMA and PWM0 generator 0 for a new burst
+static int ADC_CollectStart(uint32_t channelNum, uint32_t fs){
+  volatile uint32_t delay;
+  uint32_t div = 0;                          // PWM clock is 80 MHz/2^(div+1)
+  uint32_t load = 80000000/fs;
+  uint32_t rcc = SYSCTL_RCC_R&~(SYSCTL_RCC_USEPWMDIV|SYSCTL_RCC_PWMDIV_M);
+  if(ADC_PinInit(channelNum) == 0){
+    return 0;
+  }
+  if(load > 65536){                          // 16-bit counter, use the divider
+    load = load/2;
+    while((load > 65536) && (div < 5)){
+      load = load/2;
+      div++;
+    }
+    if(load > 65536){
+      return 0;                              // below 20 Hz
+    }
+    rcc |= SYSCTL_RCC_USEPWMDIV|(div<<17);
+  }
+  SYSCTL_RCGCDMA_R |= 0x01;          // activate uDMA
+  SYSCTL_RCGCADC_R |= 0x02;          // activate ADC1
+  SYSCTL_RCGCPWM_R |= 0x01;          // activate PWM0
+  delay = SYSCTL_RCGCPWM_R;
+  delay = SYSCTL_RCGCPWM_R;
+  PWM0_0_CTL_R = 0;                  // stop while setting up
+  SYSCTL_RCC_R = rcc;                // PWM clock divider, nothing else uses it
+  PWM0_0_LOAD_R = load - 1;          // counts down, one trigger per load clocks
+  PWM0_0_INTEN_R = PWM_0_INTEN_TRCNTZERO;
+  UDMA_CFG_R = 0x01;                 // master enable
+  UDMA_CTLBASE_R = (uint32_t)UDMA_Table;
+  UDMA_ENACLR_R = 1<<UDMA_CH_ADC1SS3;
+  UDMA_CHMAP3_R = (UDMA_CHMAP3_R&0xFFFF0FFF)|(1<<12);  // channel 27 is ADC1 SS3
+  UDMA_PRIOCLR_R = 1<<UDMA_CH_ADC1SS3;
+  UDMA_USEBURSTCLR_R = 1<<UDMA_CH_ADC1SS3;
+  UDMA_REQMASKCLR_R = 1<<UDMA_CH_ADC1SS3;
+  ADC1_PC_R = ADC_PC_SR_1M;
+  ADC1_SSPRI_R = 0x3210;
+  ADC1_ACTSS_R &= ~0x08;             // disable sample sequencer 3
+  ADC1_EMUX_R = (ADC1_EMUX_R&0xFFFF0FFF)+0x6000; // PWM generator 0
+  ADC1_TSSEL_R &= ~0x30;             // generator 0 of PWM0
+  if(channelNum == ADC_TEMPSENSOR){
+    ADC1_SSMUX3_R = 0;
+    ADC1_SSCTL3_R = 0x0E;            // temperature sensor, flag and end
+  } else{
+    ADC1_SSMUX3_R = channelNum;
+    ADC1_SSCTL3_R = 0x06;            // set flag and end
+  }
+  ADC1_IM_R &= ~ADC_IM_MASK3;        // uDMA done interrupts only, not per sample
+  ADC1_ACTSS_R |= 0x08;              // enable sample sequencer 3
+  NVIC_PRI12_R = (NVIC_PRI12_R&0x00FFFFFF)|0x40000000; // priority 2
+  NVIC_EN1_R = 1<<(51-32);           // enable interrupt 51 in NVIC
+  ADC_CollectChannel = channelNum;
+  ADC_CollectFs = fs;
+  return 1;
+}
+
+// ******** ADC_CollectHook ************
+// Set the function that runs when each capture finishes or is aborted
+// Inputs:  task runs in the ADC1 ISR, or in ADC_Stop, with the buffer
+//               and the number of samples in it, 0 for none
+// Outputs: none
+void ADC_CollectHook(void(*task)(uint16_t *buffer, uint32_t count)){
+  ADC_CollectTask = task;
+}
+
+// ******** ADC_Collect ************
+// Start a burst of samples into a buffer, does not wait
+// If a burst is running, the new one is queued and starts on the
+// very next sample.  Queued bursts must use the same channel and rate.
+// Unprivileged threads reach OS_ADC_Collect through SVC instead,
+// which queues the burst here and signals only the caller when it
+// is done
+// Inputs:  channelNum 0 to 11 or ADC_TEMPSENSOR
+//          fs sampling rate in Hz, 20 to 1,000,000
+//          buffer room for numberOfSamples samples
+//          numberOfSamples 1 to 1024
+// Outputs: 1 if started or queued, 0 on a bad channel, count or
+//          rate, a different channel or rate than the running
+//          burst, or a full queue
+int ADC_Collect(uint32_t channelNum, uint32_t fs, uint16_t *buffer, uint32_t numberOfSamples){
+  long sr;
+  uint32_t index;
+  if(OS_Unprivileged()){
+    return SVC_ADCCollect(channelNum, fs, buffer, numberOfSamples);
+  }
+  if((numberOfSamples == 0) || (numberOfSamples > UDMA_MAXBLOCK) ||
+     (fs == 0) || (fs > 1000000) || ADC_DualTask){  // dual capture owns ADC1
+    return 0;
+  }
+  sr = StartCritical();
+  if(ADC_CollectNum == 0){
+    if(ADC_CollectStart(channelNum, fs) == 0){
+      EndCritical(sr);
+      return 0;
+    }
+    ADC_CollectHead = 0;
+    ADC_CollectAlt = 0;
+    ADC_CollectBuf[0] = buffer;
+    ADC_CollectCount[0] = numberOfSamples;
+    ADC_CollectNum = 1;
+    UDMA_ALTCLR_R = 1<<UDMA_CH_ADC1SS3;      // start with the primary structure
+    ADC_CollectArm(DMA_PRI(UDMA_CH_ADC1SS3), 0);
+    DMA_ALT(UDMA_CH_ADC1SS3)[2] = UDMA_CHCTL_XFERMODE_STOP;
+    UDMA_ENASET_R = 1<<UDMA_CH_ADC1SS3;
+    PWM0_0_CTL_R = PWM_0_CTL_ENABLE;         // first trigger one period from now
+    EndCritical(sr);
+    return 1;
+  }
+  if((channelNum != ADC_CollectChannel) || (fs != ADC_CollectFs) ||
+     (ADC_CollectNum == ADC_COLLECTQUEUE)){
+    EndCritical(sr);
+    return 0;
+  }
+  index = (ADC_CollectHead+ADC_CollectNum)%ADC_COLLECTQUEUE;
+  ADC_CollectBuf[index] = buffer;
+  ADC_CollectCount[index] = numberOfSamples;
+  ADC_CollectNum++;
+  if(ADC_CollectNum == 2){                   // other structure is free, arm it now
+    ADC_CollectArm(ADC_CollectCtl(1), index);
+  }
+  EndCritical(sr);
+  return 1;
+}
+
+// ******** ADC_Stop ************
+// Abort the running burst and drop the queued ones
+// The hook still runs for each, with the samples captured so far
+// Threads reach this through SVC
+// Inputs:  none
+// Outputs: number of bursts that were aborted, 0 if idle
+int ADC_Stop(void){
+  long sr;
+  uint32_t *ctl;
+  uint32_t count, index;
+  uint32_t aborted;
+  if(OS_Unprivileged()){
+    return SVC_ADCStop();
+  }
+  sr = StartCritical();
+  if(ADC_CollectNum == 0){
+    EndCritical(sr);
+    return 0;
+  }
+  PWM0_0_CTL_R = 0;                          // no more triggers
+  ADC_CollectHandler();                      // retire any that did finish
+  UDMA_ENACLR_R = 1<<UDMA_CH_ADC1SS3;
+  aborted = ADC_CollectNum;
+  while(ADC_CollectNum){
+    index = ADC_CollectHead;
+    ctl = ADC_CollectCtl(0);
+    count = 0;
+    if(aborted == ADC_CollectNum){           // the oldest is partly full
+      count = ADC_CollectCount[index] - ((ctl[2]>>4)&0x3FF) - 1;
+    }
+    ctl[2] = UDMA_CHCTL_XFERMODE_STOP;
+    ADC_CollectNum--;
+    ADC_CollectAlt ^= 1;
+    ADC_CollectHead = (ADC_CollectHead+1)%ADC_COLLECTQUEUE;
+    if(ADC_CollectTask){
+      ADC_CollectTask(ADC_CollectBuf[index], count);
+    }
+  }
+  EndCritical(sr);
+  return (int)aborted;
+}
+
+//------------Digital comparators----------------
+// SS2 converts up to four channels on every Timer0A trigger and
+// sends each result to its own digital comparator instead of the
+// FIFO, so nothing runs on the CPU until a comparator sees its band.
+// Comparator n takes step n of SS2.  Bands are set by DCCMP,
+// low is below COMP0, mid is COMP0 to COMP1-1, high is COMP1 and up.
+#define ADC_DCMAX          4           // SS2 has four steps
+#define ADC_DCCTL_CIE      0x00000010  // comparator interrupt enable
+#define ADC_DCCTL_CIM_ONCE 0x00000001  // once per entry into the band
+#define ADC_IM_DCONSS2     0x00040000  // comparator interrupts on the SS2 line
+#define ADC_ISC_DCINSS2    0x00040000
+static uint32_t ADC_DCNum;             // comparators in use, steps 0 to ADC_DCNum-1
+static uint32_t ADC_DCOneShot;         // bit n set if comparator n disarms itself
+static void (*ADC_DCTask)(uint32_t comps);
+#define ADC_DCCTL(n) ((&ADC0_DCCTL0_R)[n])
+#define ADC_DCCMP(n) ((&ADC0_DCCMP0_R)[n])
+
+// the only SS2 interrupt is from the comparators
+RAMFUNC void ADC0Seq2_Handler(void){
+  uint32_t comps = ADC0_DCISC_R&((1<<ADC_DCNum)-1);
+  uint32_t i;
+  ADC0_DCISC_R = comps;        // acknowledge those comparators
+  ADC0_ISC_R = ADC_ISC_DCINSS2;
+  for(i = 0; i < ADC_DCNum; i++){
+    if(comps&ADC_DCOneShot&(1<<i)){
+      ADC_DCCTL(i) &= ~ADC_DCCTL_CIE;  // disarmed until ADC_ArmComparator
+    }
+  }
+  if(ADC_DCTask){
+    ADC_DCTask(comps);
+  }
+}
+
+// ******** ADC_ComparatorHook ************
+// Set the function that runs when comparators fire
+// Inputs:  task runs in the ADC0 SS2 ISR with bit n set for each
+//               comparator n that fired, 0 for none
+// Outputs: none
+void ADC_ComparatorHook(void(*task)(uint32_t comps)){
+  ADC_DCTask = task;
+}
+
+// ******** ADC_InitComparator ************
+// Watch one channel with the next free digital comparator, it
+// converts on every Timer0A trigger, so the rate is the one set
+// by ADC_Init, ADC_InitDMA or ADC_InitScan
+// Privileged only, call before OS_Launch
+// Inputs:  channelNum 0 to 11 or ADC_TEMPSENSOR
+//          low COMP0, high COMP1, 0 to 4095, low <= high
+//          config one band, ADC_DC_LOW, ADC_DC_MID or ADC_DC_HIGH,
+//                 plus any of
+//                 ADC_DC_HYST    fire on entering the low or high band,
+//                                then not again until the value has
+//                                been in the opposite band
+//                 ADC_DC_LEVEL   fire on every sample in the band,
+//                                otherwise once per entry
+//                 ADC_DC_ONESHOT fire once, then stay quiet until
+//                                ADC_ArmComparator
+// Outputs: comparator number 0 to 3, -1 if all are in use or
+//          on a bad channel, threshold or config
+int ADC_InitComparator(uint8_t channelNum, uint32_t low, uint32_t high, uint32_t config){
+  volatile uint32_t delay;
+  uint32_t n = ADC_DCNum;
+  uint32_t ctl;
+  if((n == ADC_DCMAX) || (low > high) || (high > 4095) ||
+     (((config&ADC_DC_BAND_M) == ADC_DC_MID) && (config&ADC_DC_HYST)) ||
+     ((config&ADC_DC_BAND_M) == 0x08) || (ADC_PinInit(channelNum) == 0)){
+    return -1;
+  }
+  SYSCTL_RCGCADC_R |= 0x01;          // activate ADC0
+  delay = SYSCTL_RCGCADC_R;
+  delay = SYSCTL_RCGCADC_R;
+  ADC0_ACTSS_R &= ~0x04;             // disable sample sequencer 2
+  ADC0_EMUX_R = (ADC0_EMUX_R&0xFFFFF0FF)+0x0500; // timer trigger event
+  if(channelNum == ADC_TEMPSENSOR){
+    ADC0_SSMUX2_R &= ~(0x0F<<(4*n));
+    ADC0_SSCTL2_R = (ADC0_SSCTL2_R&~(0x0F<<(4*n)))|(0x08<<(4*n));  // TSn
+  } else{
+    ADC0_SSMUX2_R = (ADC0_SSMUX2_R&~(0x0F<<(4*n)))|(channelNum<<(4*n));
+    ADC0_SSCTL2_R &= ~(0x0F<<(4*n));
+  }
+  ADC0_SSCTL2_R |= 0x02<<(4*n);      // new last step
+  if(n > 0){
+    ADC0_SSCTL2_R &= ~(0x02<<(4*(n-1)));
+  }
+  ADC0_SSOP2_R |= 0x01<<(4*n);       // result goes to a comparator
+  ADC0_SSDC2_R = (ADC0_SSDC2_R&~(0x0F<<(4*n)))|(n<<(4*n));  // comparator n
+  ADC_DCCMP(n) = (high<<16)|low;
+  ctl = (config&(ADC_DC_BAND_M|ADC_DC_HYST))|ADC_DCCTL_CIE;
+  if((config&ADC_DC_LEVEL) == 0){
+    ctl |= ADC_DCCTL_CIM_ONCE;
+  }
+  ADC_DCCTL(n) = ctl;
+  ADC0_DCRIC_R = 1<<n;               // start from a clean state
+  if(config&ADC_DC_ONESHOT){
+    ADC_DCOneShot |= 1<<n;
+  } else{
+    ADC_DCOneShot &= ~(1<<n);
+  }
+  ADC_DCNum = n + 1;
+  ADC0_IM_R |= ADC_IM_DCONSS2;
+  ADC0_ACTSS_R |= 0x04;              // enable sample sequencer 2
+  NVIC_PRI4_R = (NVIC_PRI4_R&0xFFFFFF00)|0x00000040; // priority 2
+  NVIC_EN0_R = 1<<16;                // enable interrupt 16 in NVIC
+  return n;
+}
+
+// ******** ADC_ArmComparator ************
+// Let a one-shot comparator fire again, the band state is reset
+// so it fires as soon as the value is in the band
+// Threads reach this through SVC
+// Inputs:  comp comparator number from ADC_InitComparator
+// Outputs: 1 if successful, 0 if comp is not in use
+int ADC_ArmComparator(uint32_t comp){
+  if(OS_Unprivileged()){
+    return SVC_ADCArmComparator(comp);
+  }
+  if(comp >= ADC_DCNum){
+    return 0;
+  }
+  ADC0_DCRIC_R = 1<<comp;
+  ADC0_DCISC_R = 1<<comp;            // drop an event from before
+  ADC_DCCTL(comp) |= ADC_DCCTL_CIE;
+  return 1;
+}
+
+// ******** ADC_InitDMA ************
+// Sample one channel from the Timer0A trigger into memory by uDMA
+// Two blocks fill alternately.  When one is full, task runs in the
+// ADC ISR with it and returns the block to fill next, the same
+// one to reuse it or a new one, e.g., from MemPool, so full blocks
+// can be handed to a thread without copying
+// Privileged only, call before OS_Launch
+// Inputs:  channelNum 0 to 11
+//          fs sampling rate in Hz, 1 to 1,000,000
+//          ping, pong two blocks of count samples
+//          count samples per block, 1 to 1024
+//          task runs once per block, in the ADC ISR
+// Outputs: 1 if successful, 0 on a bad count or rate
+int ADC_InitDMA(uint8_t channelNum, uint32_t fs, uint16_t *ping, uint16_t *pong,
+                uint32_t count, uint16_t *(*task)(uint16_t *full)){
+  volatile uint32_t delay;
+  if((count == 0) || (count > UDMA_MAXBLOCK) ||
+     (fs == 0) || (fs > 1000000)){
+    return 0;
+  }
+  SYSCTL_RCGCDMA_R |= 0x01;          // activate uDMA
+  delay = SYSCTL_RCGCDMA_R;
+  UDMA_CFG_R = 0x01;                 // master enable
+  UDMA_CTLBASE_R = (uint32_t)UDMA_Table;
+  UDMA_ENACLR_R = 1<<UDMA_CH_ADC0SS3;
+  UDMA_CHMAP2_R = (UDMA_CHMAP2_R&0xFFFFFF0F)|(0<<4);  // channel 17 is ADC0 SS3
+  UDMA_PRIOCLR_R = 1<<UDMA_CH_ADC0SS3;      // default priority
+  UDMA_USEBURSTCLR_R = 1<<UDMA_CH_ADC0SS3;  // ADC uses burst requests of 1
+  UDMA_REQMASKCLR_R = 1<<UDMA_CH_ADC0SS3;   // allow requests from SS3
+  UDMA_ALTCLR_R = 1<<UDMA_CH_ADC0SS3;       // start with the primary structure
+  ADC_BlockSize = count;
+  ADC_BlockControl = UDMA_CHCTL_DSTINC_16|UDMA_CHCTL_DSTSIZE_16|
+                     UDMA_CHCTL_SRCINC_NONE|UDMA_CHCTL_SRCSIZE_16|
+                     UDMA_CHCTL_ARBSIZE_1|((count-1)<<4)|UDMA_CHCTL_XFERMODE_PINGPONG;
+  ADC_PriBuf = ping;
+  ADC_AltBuf = pong;
+  ADC_DMAArm(DMA_PRI(UDMA_CH_ADC0SS3), ping);
+  ADC_DMAArm(DMA_ALT(UDMA_CH_ADC0SS3), pong);
+  ADC_BlockTask = task;
+  UDMA_ENASET_R = 1<<UDMA_CH_ADC0SS3;       // ready before the first trigger
+  ADC0_InitTimer0ATriggerSeq3(channelNum, 80000000/fs);
+  ADC0_IM_R &= ~ADC_IM_MASK3;               // no interrupt per conversion, IE0 still requests uDMA
+  ADC0_PC_R = ADC_PC_SR_1M;                 // faster than the 125 ksps default
+  return 1;
+}
+
+// ******** ADC_BlockTime ************
+// Hardware time stamp of the block ADC_InitDMA just filled
+// Call from its task, in the ADC ISR
+// Inputs:  none
+// Outputs: OS_Time at which the first sample of the block was taken
+unsigned long ADC_BlockTime(void){
+  return ADC_BlockStart;
+}
+
+//------------Scan on SS0----------------
+// one Timer0A trigger converts up to eight channels back to back,
+// so all channels of a scan are sampled within a few microseconds
+// of each other, and SS0 interrupts once at the end of the scan
+#define ADC_SCANMAX  8               // SS0 has an eight entry FIFO
+static uint32_t ADC_ScanChannels;    // entries per scan
+static uint16_t * const *ADC_ScanBuffers;  // one buffer per channel
+static uint32_t ADC_ScanLength;      // scans per buffer
+static uint32_t ADC_ScanIndex;       // next entry in every buffer
+static void (*ADC_ScanTask)(uint32_t length);
+
+// ******** ADC_InitScan ************
+// Sample several channels on every Timer0A trigger with ADC0 SS0,
+// results are de-interleaved into one buffer per channel
+// Privileged only, call before OS_Launch
+// Inputs:  channels list of 1 to 8 channel numbers, 0 to 11 or
+//                   ADC_TEMPSENSOR, a channel may appear twice
+//          numChannels entries in channels and buffers
+//          fs scans per second, 1 to 1,000,000/numChannels
+//          buffers one buffer of length samples per channel
+//          length scans before the buffers wrap
+//          task runs in the ADC ISR each time the buffers are
+//               full, with length, 0 for none
+// Outputs: 1 if successful, 0 on a bad channel, count or rate
+int ADC_InitScan(const uint8_t *channels, uint32_t numChannels, uint32_t fs,
+                 uint16_t * const *buffers, uint32_t length,
+                 void(*task)(uint32_t length)){
+  uint32_t i, mux, ctl;
+  if((numChannels == 0) || (numChannels > ADC_SCANMAX) || (length == 0) ||
+     (fs == 0) || (fs > 1000000/numChannels)){  // 1 Msps shared by the scan
+    return 0;
+  }
+  mux = 0;
+  ctl = 0;
+  for(i = 0; i < numChannels; i++){
+    if(ADC_PinInit(channels[i]) == 0){
+      return 0;
+    }
+    if(channels[i] == ADC_TEMPSENSOR){
+      ctl |= ADC_SSCTL0_TS0<<(4*i);  // internal sensor instead of MUX
+    } else{
+      mux |= channels[i]<<(4*i);
+    }
+  }
+  ctl |= (ADC_SSCTL0_IE0|ADC_SSCTL0_END0)<<(4*(numChannels-1));  // flag and end on last
+  ADC_ScanChannels = numChannels;
+  ADC_ScanBuffers = buffers;
+  ADC_ScanLength = length;
+  ADC_ScanIndex = 0;
+  ADC_ScanTask = task;
+  DisableInterrupts();
+  SYSCTL_RCGCADC_R |= 0x01;     // activate ADC0 
+  ADC_Timer0AInit(80000000/fs);
+  ADC0_PC_R = ADC_PC_SR_1M;     // every channel of a scan is one conversion
+  ADC0_SSPRI_R = 0x3210;        // sequencer 0 is highest, sequencer 3 is lowest
+  ADC0_ACTSS_R &= ~0x01;        // disable sample sequencer 0
+  ADC0_EMUX_R = (ADC0_EMUX_R&0xFFFFFFF0)+0x0005; // timer trigger event
+  ADC0_SSMUX0_R = mux;
+  ADC0_SSCTL0_R = ctl;
+  ADC0_IM_R |= 0x01;            // enable SS0 interrupts
+  ADC0_ACTSS_R |= 0x01;         // enable sample sequencer 0
+  NVIC_PRI3_R = (NVIC_PRI3_R&0xFF00FFFF)|0x00400000; // priority 2
+  NVIC_EN0_R = 1<<14;           // enable interrupt 14 in NVIC
+  EnableInterrupts();
+  return 1;
+}
+
+RAMFUNC void ADC0Seq0_Handler(void){
+  uint32_t i;
+  ADC0_ISC_R = 0x01;            // acknowledge ADC sequence 0 completion
+  for(i = 0; i < ADC_ScanChannels; i++){  // FIFO holds the scan in order
+    ADC_ScanBuffers[i][ADC_ScanIndex] = ADC0_SSFIFO0_R&ADC_SSFIFO0_DATA_M;
+  }
+  ADC_ScanIndex++;
+  if(ADC_ScanIndex == ADC_ScanLength){
+    ADC_ScanIndex = 0;
+    if(ADC_ScanTask){
+      ADC_ScanTask(ADC_ScanLength);
+    }
+  }
+}
+
+// ******** ADC_SetAveraging ************
+// Average 2^n conversions in hardware for every result ADC0 reports,
+// for all of its sequencers.  Each result then takes 2^n conversion
+// times, so the trigger rate times 2^n must stay within the ADC rate.
+// Can be called before or after ADC_Init, ADC_InitDMA or ADC_InitScan
+// Privileged only
+// Inputs:  n 0 for none, 1 to 6 for 2x to 64x
+// Outputs: 1 if successful, 0 if n is too big
+int ADC_SetAveraging(uint32_t n){
+  volatile uint32_t delay;
+  if(n > ADC_SAC_AVG_64X){
+    return 0;
+  }
+  SYSCTL_RCGCADC_R |= 0x01;     // activate ADC0 
+  delay = SYSCTL_RCGCADC_R;
+  delay = SYSCTL_RCGCADC_R;
+  ADC0_SAC_R = n;
+  return 1;
+}
+
 void ADC_Open(uint32_t channelNum) {
 	uint32_t period = 100;
 	ADC0_InitTimer0ATriggerSeq3((uint8_t)channelNum, period);
@@ -275,8 +1027,14 @@ uint16_t ADC_In(void) {
 	return (uint16_t)ADCvalue;
 }
 
-void ADC_Init(unsigned int channelNum, uint32_t freq, void(*task)(uint32_t hi)) {	
-	uint32_t period = (80000000/freq) - 1; // Bus clock divided by desired freq is the period between triggers we want
+// NVIC is privileged, so threads reach this through SVC
+int ADC_Init(unsigned int channelNum, uint32_t freq, void(*task)(uint32_t hi)) {	
+	uint32_t period;
+	if(OS_Unprivileged()){
+		return SVC_ADCInit(channelNum, freq, task);
+	}
+	period = (80000000/freq) - 1; // Bus clock divided by desired freq is the period between triggers we want
 	ADC_ISR = task;
 	ADC0_InitTimer0ATriggerSeq3((uint8_t)channelNum, period);
+	return 1;
 }
@@ -26,11 +26,10 @@
 // following parameters.  Any parameters not explicitly listed
 // below are not modified:
 // Timer0A: enabled
-// Mode: 16-bit, down counting
+// Mode: 32-bit, down counting
 // One-shot or periodic: periodic
-// Prescale value: programmable using variable 'prescale' [0:255]
-// Interval value: programmable using variable 'period' [0:65535]
-// Sample time is busPeriod*(prescale+1)*(period+1)
+// Interval value: programmable using 32-bit period
+// Sample time is busPeriod*period
 // Max sample rate: <=125,000 samples/second
 // Sequencer 0 priority: 1st (highest)
 // Sequencer 1 priority: 2nd
@@ -42,10 +41,158 @@
 // channelNum must be 0-11 (inclusive) corresponding to Ain0 through Ain11
 void ADC0_InitTimer0ATriggerSeq3(uint8_t channelNum, uint32_t period);
 
+// ******** ADC_SetAveraging ************
+// Average 2^n conversions in hardware for every result ADC0 reports.
+// Each result then takes 2^n conversion times, so the trigger rate
+// times 2^n must stay within the ADC rate.
+// Can be called before or after ADC_Init, ADC_InitDMA or ADC_InitScan
+// Privileged only
+// Inputs:  n 0 for none, 1 to 6 for 2x to 64x
+// Outputs: 1 if successful, 0 if n is too big
+int ADC_SetAveraging(uint32_t n);
+
+// ******** ADC_InitDual ************
+// Sample two channels at the same instant, one on ADC0 and one on
+// ADC1, both started by Timer0A, into blocks of interleaved pairs
+// by uDMA, ping-pong
+// Privileged only, call before OS_Launch
+// Inputs:  chA channel for ADC0, chB channel for ADC1, 0 to 11
+//          fs pairs per second, 1 to 1,000,000
+//          ping, pong two blocks of count pairs
+//          count pairs per block, 1 to 1024
+//          task runs in the ADC ISR when a block is full, with the
+//               block, count and the OS_Time of its first pair,
+//               and must be done with it one block time later
+// Outputs: 1 if successful, 0 on a bad channel, count or rate
+int ADC_InitDual(uint8_t chA, uint8_t chB, uint32_t fs, uint32_t *ping, uint32_t *pong,
+                 uint32_t count, void(*task)(uint32_t *pairs, uint32_t count, unsigned long time));
+#define ADC_PAIR_A(pair) ((pair)&0xFFFF)   // ADC0 sample of a pair
+#define ADC_PAIR_B(pair) ((pair)>>16)      // ADC1 sample of a pair
+
+// channel number that selects the internal temperature sensor
+// in ADC_InitScan, temperature in 0.1 C = 1475 - (2475*sample)/4096
+#define ADC_TEMPSENSOR 12
+
+// ******** ADC_InitScan ************
+// Sample several channels on every Timer0A trigger with ADC0 SS0,
+// results are de-interleaved into one buffer per channel
+// Privileged only, call before OS_Launch
+// Inputs:  channels list of 1 to 8 channel numbers, 0 to 11 or
+//                   ADC_TEMPSENSOR, a channel may appear twice
+//          numChannels entries in channels and buffers
+//          fs scans per second, 1 to 1,000,000/numChannels
+//          buffers one buffer of length samples per channel
+//          length scans before the buffers wrap
+//          task runs in the ADC ISR each time the buffers are
+//               full, with length, 0 for none
+// Outputs: 1 if successful, 0 on a bad channel, count or rate
+int ADC_InitScan(const uint8_t *channels, uint32_t numChannels, uint32_t fs,
+                 uint16_t * const *buffers, uint32_t length,
+                 void(*task)(uint32_t length));
+
 void ADC_Open(uint32_t channelNum);
 
 uint16_t ADC_In(void);
 
+// digital comparator configuration, one band plus options
+#define ADC_DC_LOW      0x00    // below low
+#define ADC_DC_MID      0x04    // low to high-1
+#define ADC_DC_HIGH     0x0C    // high and above
+#define ADC_DC_BAND_M   0x0C
+#define ADC_DC_HYST     0x02    // low or high band only, rearm in the opposite band
+#define ADC_DC_LEVEL    0x100   // every sample in the band, not once per entry
+#define ADC_DC_ONESHOT  0x200   // once, then quiet until ADC_ArmComparator
+
+// ******** ADC_ComparatorHook ************
+// Set the function that runs when comparators fire
+// Inputs:  task runs in the ADC0 SS2 ISR with bit n set for each
+//               comparator n that fired, 0 for none
+// Outputs: none
+void ADC_ComparatorHook(void(*task)(uint32_t comps));
+
+// ******** ADC_InitComparator ************
+// Watch one channel with the next free digital comparator, it
+// converts on every Timer0A trigger, so the rate is the one set
+// by ADC_Init, ADC_InitDMA or ADC_InitScan
+// Privileged only, call before OS_Launch
+// Inputs:  channelNum 0 to 11 or ADC_TEMPSENSOR
+//          low COMP0, high COMP1, 0 to 4095, low <= high
+//          config one band, ADC_DC_LOW, ADC_DC_MID or ADC_DC_HIGH,
+//                 plus any of ADC_DC_HYST, ADC_DC_LEVEL, ADC_DC_ONESHOT
+// Outputs: comparator number 0 to 3, -1 if all are in use or
+//          on a bad channel, threshold or config
+int ADC_InitComparator(uint8_t channelNum, uint32_t low, uint32_t high, uint32_t config);
+
+// ******** ADC_ArmComparator ************
+// Let a one-shot comparator fire again, the band state is reset
+// so it fires as soon as the value is in the band
+// Threads reach this through SVC
+// Inputs:  comp comparator number from ADC_InitComparator
+// Outputs: 1 if successful, 0 if comp is not in use
+int ADC_ArmComparator(uint32_t comp);
+
+// ******** ADC_CollectHook ************
+// Set the function that runs when each capture finishes or is aborted
+// Inputs:  task runs in the ADC1 ISR, or in ADC_Stop, with the buffer
+//               and the number of samples in it, 0 for none
+// Outputs: none
+void ADC_CollectHook(void(*task)(uint16_t *buffer, uint32_t count));
+
+// ******** ADC_Collect ************
+// Start a burst of samples into a buffer on ADC1, does not wait
+// If a burst is running, the new one is queued and starts on the
+// very next sample.  Queued bursts must use the same channel and rate.
+// Unprivileged threads reach OS_ADC_Collect through SVC instead,
+// which queues the burst here and signals only the caller when it
+// is done
+// Inputs:  channelNum 0 to 11 or ADC_TEMPSENSOR
+//          fs sampling rate in Hz, 20 to 1,000,000
+//          buffer room for numberOfSamples samples
+//          numberOfSamples 1 to 1024
+// Outputs: 1 if started or queued, 0 on a bad channel, count or
+//          rate, a different channel or rate than the running
+//          burst, or a full queue
+int ADC_Collect(uint32_t channelNum, uint32_t fs, uint16_t *buffer, uint32_t numberOfSamples);
+
+// ******** ADC_Stop ************
+// Abort the running burst and drop the queued ones
+// The hook still runs for each, with the samples captured so far
+// Threads reach this through SVC
+// Inputs:  none
+// Outputs: number of bursts that were aborted, 0 if idle
 int ADC_Stop(void);
 
 int ADC_Init(unsigned int channelNum, uint32_t period, void(*task)(uint32_t hi));
+
+// ******** ADC_InitDMA ************
+// Sample one channel from the Timer0A trigger into memory by uDMA,
+// ping-pong blocks, one interrupt per block
+// Privileged only, call before OS_Launch
+// Inputs:  channelNum 0 to 11
+//          fs sampling rate in Hz, 1 to 1,000,000
+//          ping, pong two blocks of count samples
+//          count samples per block, 1 to 1024
+//          task runs once per block in the ADC ISR with the full
+//          block and returns the block to fill next, ADC_BlockTime
+//          is the time stamp of the block
+// Outputs: 1 if successful, 0 on a bad count or rate
+int ADC_InitDMA(uint8_t channelNum, uint32_t fs, uint16_t *ping, uint16_t *pong,
+                uint32_t count, uint16_t *(*task)(uint16_t *full));
+
+// ******** ADC_BlockTime ************
+// Hardware time stamp of the block ADC_InitDMA just filled, from
+// the Timer0A count, so ISR latency is not in it
+// Call from its task, in the ADC ISR
+// Inputs:  none
+// Outputs: OS_Time at which the first sample of the block was taken,
+//          sample i was taken i sample periods later
+unsigned long ADC_BlockTime(void);
+
+// ******** ADC_TriggerTime ************
+// OS_Time of the latest Timer0A trigger, when the ADC sampled, e.g.,
+// from the ADC_Init task to time stamp its sample.  Exact to a few
+// bus cycles if called less than one sample period after the trigger
+// Call from an ISR, it masks interrupts to read the two counters
+// Inputs:  none
+// Outputs: time in 12.5ns units
+unsigned long ADC_TriggerTime(void);
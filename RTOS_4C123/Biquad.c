@@ -0,0 +1,163 @@
+// Biquad.c
+// Runs on LM4F120/TM4C123
+// Fixed-point cascade of biquad sections, direct form I.
+// EE445M Lab 2
+
+// Direct form I keeps the input and output history of every section.
+// The output of one section is the input of the next, so the cascade
+// keeps one history per signal, NumStages+1 of them, and section k
+// reads history k as its x and history k+1 as its y.
+// In Q15 a history is one word, the older sample in the top half and
+// the newer in the bottom half, and a coefficient word holds the
+// matching pair, so SMLAD does b1*x1+b2*x2 in one instruction.
+// The sum of products is Q2.14 times Q15, shifted back by 14 and
+// saturated with SSAT.  The 32-bit sum may wrap part way through,
+// two's complement makes that harmless as long as the final sum,
+// the output before saturation, is within four times full scale.
+
+#include <stdint.h>
+#include "RamFunc.h"
+#include "Biquad.h"
+
+// ******** Biquad_Q15Init ************
+// Set up a Q15 filter and clear its state
+// Inputs:  pointer to the filter
+//          numStages number of sections in coeffs
+//          coeffs table from tools/BiquadDesign q15
+//          state BIQUAD_Q15_STATE(numStages) words
+// Outputs: none
+void Biquad_Q15Init(BiquadQ15Type *f, uint32_t numStages, const int32_t *coeffs, int32_t *state){
+  uint32_t i;
+  f->NumStages = numStages;
+  f->Coeffs = coeffs;
+  f->State = state;
+  for(i = 0; i < BIQUAD_Q15_STATE(numStages); i++){
+    state[i] = 0;
+  }
+}
+
+// ******** Biquad_Q15Step ************
+// Filter one sample
+// Inputs:  pointer to the filter
+//          x input, -32768 to 32767
+// Outputs: filtered sample, saturated to -32768 to 32767
+RAMFUNC int32_t Biquad_Q15Step(BiquadQ15Type *f, int32_t x){
+  const int32_t *c = f->Coeffs;
+  int32_t *s = f->State;
+  int32_t acc;
+  uint32_t k;
+  for(k = f->NumStages; k; k--){
+    acc = c[0]*x;                    // b0*x
+    acc = __smlad(c[1], s[0], acc);  // b1*x1 + b2*x2
+    acc = __smlad(c[2], s[1], acc);  // -a1*y1 - a2*y2
+    s[0] = __pkhbt(x, s[0], 16);     // x1 becomes x2, x becomes x1
+    x = __ssat(acc>>14, 16);         // input of the next section
+    c += BIQUAD_Q15_COEFFS;
+    s++;
+  }
+  s[0] = __pkhbt(x, s[0], 16);       // output history
+  return x;
+}
+
+// ******** Biquad_Q15 ************
+// Filter a block of samples
+// Inputs:  pointer to the filter
+//          in block of n samples
+//          out room for n samples, may be the same as in
+//          n number of samples
+// Outputs: none
+RAMFUNC void Biquad_Q15(BiquadQ15Type *f, const int16_t *in, int16_t *out, uint32_t n){
+  const int32_t *c = f->Coeffs;
+  int32_t *s = f->State;
+  int32_t b0, b12, a12, x12, y12, acc, x;
+  uint32_t k, i;
+  const int16_t *src = in;
+  for(k = f->NumStages; k; k--){     // whole block through one section at a time
+    b0 = c[0];
+    b12 = c[1];
+    a12 = c[2];
+    x12 = s[0];
+    y12 = s[1];
+    for(i = 0; i < n; i++){          // history stays in registers
+      x = src[i];
+      acc = b0*x;
+      acc = __smlad(b12, x12, acc);
+      acc = __smlad(a12, y12, acc);
+      x12 = __pkhbt(x, x12, 16);
+      acc = __ssat(acc>>14, 16);
+      y12 = __pkhbt(acc, y12, 16);
+      out[i] = (int16_t)acc;
+    }
+    s[0] = x12;
+    s[1] = y12;                      // also x12 of the next section
+    src = out;                       // next section filters in place
+    c += BIQUAD_Q15_COEFFS;
+    s++;
+  }
+}
+
+// ******** Biquad_Q31Init ************
+// Set up a Q31 filter and clear its state
+// Inputs:  pointer to the filter
+//          numStages number of sections in coeffs
+//          coeffs table from tools/BiquadDesign q31
+//          state BIQUAD_Q31_STATE(numStages) words
+// Outputs: none
+void Biquad_Q31Init(BiquadQ31Type *f, uint32_t numStages, const int32_t *coeffs, int32_t *state){
+  uint32_t i;
+  f->NumStages = numStages;
+  f->Coeffs = coeffs;
+  f->State = state;
+  for(i = 0; i < BIQUAD_Q31_STATE(numStages); i++){
+    state[i] = 0;
+  }
+}
+
+// ******** Biquad_Q31 ************
+// Filter a block of samples
+// The sum of products is Q2.30 times Q31 in 64 bits, SMLAL
+// Inputs:  pointer to the filter
+//          in block of n samples
+//          out room for n samples, may be the same as in
+//          n number of samples
+// Outputs: none
+RAMFUNC void Biquad_Q31(BiquadQ31Type *f, const int32_t *in, int32_t *out, uint32_t n){
+  const int32_t *c = f->Coeffs;
+  int32_t *s = f->State;
+  int32_t x1, x2, y1, y2, x;
+  int64_t acc;
+  uint32_t k, i;
+  const int32_t *src = in;
+  for(k = f->NumStages; k; k--){
+    x1 = s[0];
+    x2 = s[1];
+    y1 = s[2];
+    y2 = s[3];
+    for(i = 0; i < n; i++){
+      x = src[i];
+      acc = (int64_t)c[0]*x;
+      acc += (int64_t)c[1]*x1;
+      acc += (int64_t)c[2]*x2;
+      acc += (int64_t)c[3]*y1;
+      acc += (int64_t)c[4]*y2;
+      acc = acc>>30;
+      if(acc > 0x7FFFFFFF){          // saturate to 32 bits
+        acc = 0x7FFFFFFF;
+      } else if(acc < -0x7FFFFFFF-1){
+        acc = -0x7FFFFFFF-1;
+      }
+      x2 = x1;
+      x1 = x;
+      y2 = y1;
+      y1 = (int32_t)acc;
+      out[i] = y1;
+    }
+    s[0] = x1;
+    s[1] = x2;
+    s[2] = y1;                       // also x1, x2 of the next section
+    s[3] = y2;
+    src = out;
+    c += BIQUAD_Q31_COEFFS;
+    s += 2;
+  }
+}
@@ -0,0 +1,90 @@
+// Biquad.h
+// Runs on LM4F120/TM4C123
+// Fixed-point cascade of biquad (second order IIR) sections.
+// Each filter instance has its own state, so any number of filters
+// can share the code, and a block of samples goes through all the
+// sections in one call.  Tables come from tools/BiquadDesign.
+// EE445M Lab 2
+
+// Q15 filters take 16-bit samples and Q2.14 coefficients and use the
+// dual 16-bit multiply-accumulate, SMLAD, two products per cycle.
+// Q31 filters take 32-bit samples and Q2.30 coefficients and use the
+// 64-bit multiply-accumulate, SMLAL, for high-Q or very low frequency
+// sections where 16-bit feedback is too coarse.
+// One Q15 section costs about 15 cycles a sample, so a dozen
+// one-section filters at 2 kHz use well under 1% of the CPU.
+
+#ifndef __BIQUAD_H__ // do not include more than once
+#define __BIQUAD_H__
+#include <stdint.h>
+
+// words per section in a coefficient table
+#define BIQUAD_Q15_COEFFS  3   // b0, b2:b1, -a2:-a1
+#define BIQUAD_Q31_COEFFS  5   // b0, b1, b2, -a1, -a2
+
+// words of state a filter with n sections needs
+#define BIQUAD_Q15_STATE(n) ((n)+1)      // x2:x1 of each section input and the output
+#define BIQUAD_Q31_STATE(n) (2*(n)+2)    // x1, x2 of each section input and the output
+
+// one Q15 filter, e.g.,
+//   static int32_t NotchState[BIQUAD_Q15_STATE(Notch60_STAGES)];
+//   BiquadQ15Type Notch = {Notch60_STAGES, Notch60, NotchState};
+// a zero state is a filter at rest
+struct BiquadQ15{
+  uint32_t NumStages;
+  const int32_t *Coeffs;   // BIQUAD_Q15_COEFFS words per section
+  int32_t *State;          // BIQUAD_Q15_STATE(NumStages) words
+};
+typedef struct BiquadQ15 BiquadQ15Type;
+
+struct BiquadQ31{
+  uint32_t NumStages;
+  const int32_t *Coeffs;   // BIQUAD_Q31_COEFFS words per section
+  int32_t *State;          // BIQUAD_Q31_STATE(NumStages) words
+};
+typedef struct BiquadQ31 BiquadQ31Type;
+
+// ******** Biquad_Q15Init ************
+// Set up a Q15 filter and clear its state
+// Inputs:  pointer to the filter
+//          numStages number of sections in coeffs
+//          coeffs table from tools/BiquadDesign q15
+//          state BIQUAD_Q15_STATE(numStages) words
+// Outputs: none
+void Biquad_Q15Init(BiquadQ15Type *f, uint32_t numStages, const int32_t *coeffs, int32_t *state);
+
+// ******** Biquad_Q15Step ************
+// Filter one sample
+// Inputs:  pointer to the filter
+//          x input, -32768 to 32767
+// Outputs: filtered sample, saturated to -32768 to 32767
+int32_t Biquad_Q15Step(BiquadQ15Type *f, int32_t x);
+
+// ******** Biquad_Q15 ************
+// Filter a block of samples
+// Inputs:  pointer to the filter
+//          in block of n samples
+//          out room for n samples, may be the same as in
+//          n number of samples
+// Outputs: none
+void Biquad_Q15(BiquadQ15Type *f, const int16_t *in, int16_t *out, uint32_t n);
+
+// ******** Biquad_Q31Init ************
+// Set up a Q31 filter and clear its state
+// Inputs:  pointer to the filter
+//          numStages number of sections in coeffs
+//          coeffs table from tools/BiquadDesign q31
+//          state BIQUAD_Q31_STATE(numStages) words
+// Outputs: none
+void Biquad_Q31Init(BiquadQ31Type *f, uint32_t numStages, const int32_t *coeffs, int32_t *state);
+
+// ******** Biquad_Q31 ************
+// Filter a block of samples
+// Inputs:  pointer to the filter
+//          in block of n samples
+//          out room for n samples, may be the same as in
+//          n number of samples
+// Outputs: none
+void Biquad_Q31(BiquadQ31Type *f, const int32_t *in, int32_t *out, uint32_t n);
+
+#endif // __BIQUAD_H__
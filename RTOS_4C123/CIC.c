@@ -0,0 +1,72 @@
+// CIC.c
+// Runs on LM4F120/TM4C123
+// Cascaded integrator-comb decimator for ADC blocks.
+// EE445M Lab 2
+
+// The integrators run at the input rate and are allowed to wrap.
+// They and the combs are unsigned, so the wrap is defined, and
+// arithmetic modulo 2^32 makes the combs at the output rate undo it
+// exactly, as long as the true output fits in 31 bits, which
+// CIC_Init checks with the gain Ratio^Order.  Only the output is
+// converted to signed.
+
+#include <stdint.h>
+#include "CIC.h"
+
+// ******** CIC_Init ************
+// Clear the filter and set its shape
+// Inputs:  pointer to the filter
+//          order 1 to CIC_MAXORDER
+//          ratio 2 or more, one output per ratio inputs
+//          shift right shift of every output
+// Outputs: 1 if successful, 0 if 12-bit samples could overflow
+int CIC_Init(CICType *cic, uint32_t order, uint32_t ratio, uint32_t shift){
+  uint32_t i, bits;
+  if((order == 0) || (order > CIC_MAXORDER) || (ratio < 2)){
+    return 0;
+  }
+  bits = 32 - __clz(ratio-1);      // ceil(log2(ratio))
+  if(order*bits + 12 > 31){        // int32_t outputs
+    return 0;
+  }
+  for(i = 0; i < CIC_MAXORDER; i++){
+    cic->Integrator[i] = 0;
+    cic->Comb[i] = 0;
+  }
+  cic->Order = order;
+  cic->Ratio = ratio;
+  cic->Count = 0;
+  cic->Shift = shift;
+  return 1;
+}
+
+// ******** CIC_Block ************
+// Filter a block of ADC samples, the phase carries over
+// Inputs:  pointer to the filter
+//          in block of 12-bit samples
+//          n number of samples in the block
+//          out room for n/ratio+1 outputs
+// Outputs: number of outputs written
+uint32_t CIC_Block(CICType *cic, const uint16_t *in, uint32_t n, int32_t *out){
+  uint32_t i, j, num = 0;
+  uint32_t x, y;
+  for(i = 0; i < n; i++){
+    x = in[i];
+    for(j = 0; j < cic->Order; j++){   // integrators, every input
+      cic->Integrator[j] += x;
+      x = cic->Integrator[j];
+    }
+    cic->Count++;
+    if(cic->Count == cic->Ratio){      // combs, every ratio inputs
+      cic->Count = 0;
+      for(j = 0; j < cic->Order; j++){
+        y = x - cic->Comb[j];
+        cic->Comb[j] = x;
+        x = y;
+      }
+      out[num] = (int32_t)(x>>cic->Shift);
+      num++;
+    }
+  }
+  return num;
+}
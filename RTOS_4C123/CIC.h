@@ -0,0 +1,49 @@
+// CIC.h
+// Runs on LM4F120/TM4C123
+// Cascaded integrator-comb decimator for ADC blocks.  It lowers the
+// sample rate by an integer ratio and low pass filters at the same
+// time using only adds, no multiplies, so it is cheap enough to run
+// in the ADC block callback.  Averaging R samples of uncorrelated
+// noise gains about log2(R)/2 bits of resolution.
+// EE445M Lab 2
+
+#ifndef __CIC_H__ // do not include more than once
+#define __CIC_H__
+#include <stdint.h>
+
+#define CIC_MAXORDER  4
+
+// decimator state, one per channel
+struct CIC{
+  uint32_t Integrator[CIC_MAXORDER];  // wrap modulo 2^32
+  uint32_t Comb[CIC_MAXORDER]; // previous input to each comb stage
+  uint32_t Order;              // number of integrator/comb pairs, N
+  uint32_t Ratio;              // decimation ratio, R
+  uint32_t Count;              // inputs since the last output
+  uint32_t Shift;              // right shift applied to each output
+};
+typedef struct CIC CICType;
+
+// ******** CIC_Init ************
+// Clear the filter and set its shape
+// The gain is Ratio^Order, e.g., order 3 ratio 8 is 512 or 9 bits.
+// Shifting right by fewer bits than that keeps the extra resolution.
+// Inputs:  pointer to the filter
+//          order 1 to CIC_MAXORDER
+//          ratio 2 or more, one output per ratio inputs
+//          shift right shift of every output
+// Outputs: 1 if successful, 0 if 12-bit samples could overflow
+//          the int32_t outputs, order*log2(ratio)+12 > 31
+int CIC_Init(CICType *cic, uint32_t order, uint32_t ratio, uint32_t shift);
+
+// ******** CIC_Block ************
+// Filter a block of ADC samples, the block length need not be a
+// multiple of the ratio, the phase carries over to the next block
+// Inputs:  pointer to the filter
+//          in block of 12-bit samples
+//          n number of samples in the block
+//          out room for n/ratio+1 outputs
+// Outputs: number of outputs written
+uint32_t CIC_Block(CICType *cic, const uint16_t *in, uint32_t n, int32_t *out);
+
+#endif // __CIC_H__
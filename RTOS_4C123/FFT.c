@@ -0,0 +1,242 @@
+// FFT.c
+// Runs on LM4F120/TM4C123
+// Spectrum service over the STMicroelectronics radix-4 FFT kernels.
+// EE445M Lab 2
+
+// The windows are built once at init without floating point,
+// cos(k*2pi/Size) comes from FixMath_Cos in Q30, and the Blackman
+// cos(2x) term is 2*cos(x)^2-1.
+
+#include <stdint.h>
+#include <string.h>
+#include "RamFunc.h"
+#include "FixMath.h"
+#include "FFT.h"
+
+// in cr4_fft_64_stm32.s, cr4_fft_256_stm32.s and cr4_fft_1024_stm32.s
+void cr4_fft_64_stm32(void *pssOUT, void *pssIN, unsigned short Nbin);
+void cr4_fft_256_stm32(void *pssOUT, void *pssIN, unsigned short Nbin);
+void cr4_fft_1024_stm32(void *pssOUT, void *pssIN, unsigned short Nbin);
+
+#define Q30  0x40000000
+
+// build the window, and for the real path the quarter wave of
+// cosines for the split
+static int FFT_Setup(FFTType *fft, uint32_t size, uint32_t window, uint32_t hop,
+                     int16_t *windowBuf, int16_t *frame, int32_t *in, int32_t *out,
+                     int16_t *twiddle){
+  int32_t c0, sq, w;
+  uint32_t k;
+  if((window > FFT_BLACKMAN) || (hop == 0) || (hop > size)){
+    return 0;
+  }
+  for(k = 0; k < size; k++){
+    c0 = FixMath_Cos((uint32_t)(((uint64_t)k<<32)/size));  // cos(2pi*k/size)
+    if(window == FFT_HANN){          // 0.5 - 0.5cos
+      w = (Q30/2 - c0/2)>>15;
+    } else if(window == FFT_BLACKMAN){  // 0.42 - 0.5cos + 0.08cos2 = 0.34 - 0.5cos + 0.16cos^2
+      sq = (int32_t)(((int64_t)c0*c0)>>30);
+      w = (365072220 - c0/2 + (int32_t)(((int64_t)sq*10486)>>16))>>15;
+    } else{
+      w = 32768;
+    }
+    if(w > 32767){
+      w = 32767;
+    } else if(w < 0){
+      w = 0;
+    }
+    windowBuf[k] = (int16_t)w;
+    if(twiddle && (k <= size/4)){
+      w = c0>>15;
+      twiddle[k] = (w > 32767) ? 32767 : (int16_t)w;
+    }
+    frame[k] = 0;
+  }
+  fft->Size = size;
+  fft->Hop = hop;
+  fft->Window = windowBuf;
+  fft->Frame = frame;
+  fft->In = in;
+  fft->Out = out;
+  fft->Twiddle = twiddle;
+  return 1;
+}
+
+// ******** FFT_Init ************
+// Set up a spectrum analyzer, build its window and clear its frame
+// Inputs:  pointer to the analyzer
+//          size 64, 256 or 1024
+//          window FFT_RECTANGULAR, FFT_HANN or FFT_BLACKMAN
+//          hop new samples per spectrum, 1 to size
+//          windowBuf, frame size samples each
+//          in, out size words each, out must not be in
+// Outputs: 1 if successful, 0 on a bad size, window or hop
+int FFT_Init(FFTType *fft, uint32_t size, uint32_t window, uint32_t hop,
+             int16_t *windowBuf, int16_t *frame, int32_t *in, int32_t *out){
+  switch(size){
+    case 64:   fft->Kernel = &cr4_fft_64_stm32;   break;
+    case 256:  fft->Kernel = &cr4_fft_256_stm32;  break;
+    case 1024: fft->Kernel = &cr4_fft_1024_stm32; break;
+    default: return 0;
+  }
+  return FFT_Setup(fft, size, window, hop, windowBuf, frame, in, out, 0);
+}
+
+// ******** FFT_InitReal ************
+// Set up a spectrum analyzer for real samples, which packs size
+// samples as size/2 complex values for the half size kernel, so it
+// costs about the same as FFT_Init with half the size
+// Inputs:  pointer to the analyzer
+//          size 128, 512 or 2048
+//          window FFT_RECTANGULAR, FFT_HANN or FFT_BLACKMAN
+//          hop new samples per spectrum, 1 to size
+//          windowBuf, frame size samples each
+//          in, out size/2 words each, out must not be in
+//          twiddle size/4+1 values
+// Outputs: 1 if successful, 0 on a bad size, window or hop
+int FFT_InitReal(FFTType *fft, uint32_t size, uint32_t window, uint32_t hop,
+                 int16_t *windowBuf, int16_t *frame, int32_t *in, int32_t *out,
+                 int16_t *twiddle){
+  switch(size){
+    case 128:  fft->Kernel = &cr4_fft_64_stm32;   break;
+    case 512:  fft->Kernel = &cr4_fft_256_stm32;  break;
+    case 2048: fft->Kernel = &cr4_fft_1024_stm32; break;
+    default: return 0;
+  }
+  return FFT_Setup(fft, size, window, hop, windowBuf, frame, in, out, twiddle);
+}
+
+// Turn the transform Z of z[n] = x[2n] + j*x[2n+1], M = size/2
+// points, into the first M bins of the transform X of x, in place.
+// With A = Z[k] and B = conj(Z[M-k]), the even and odd halves are
+//   E = (A+B)/2, O = -j(A-B)/2, X[k] = (E + W^k*O)/2
+// where W = exp(-j2pi/size), and the last /2 matches the 1/size
+// scale of the complex path.  The same E and O give X[M-k], so
+// each pair is done together.  X[0] is real, the Nyquist bin is
+// dropped.  cos and sin of 2pi*k/size both come from the quarter
+// wave, sin(2pi*k/size) = cos(2pi*(size/4-k)/size).
+static void FFT_Split(FFTType *fft){
+  int32_t *z = fft->Out;
+  const int16_t *cosine = fft->Twiddle;
+  uint32_t m = fft->Size/2;
+  uint32_t quarter = fft->Size/4;
+  uint32_t k;
+  int32_t ar, ai, br, bi, er, ei, odr, odi, tr, ti, c, s;
+  ar = (int16_t)z[0];
+  ai = z[0]>>16;
+  z[0] = ((ar + ai)/2)&0xFFFF;
+  for(k = 1; k <= m/2; k++){
+    ar = (int16_t)z[k];
+    ai = z[k]>>16;
+    br = (int16_t)z[m-k];            // conj(Z[M-k])
+    bi = -(z[m-k]>>16);
+    er = (ar + br)/2;
+    ei = (ai + bi)/2;
+    odr = (ai - bi)/2;               // -j*(A-B)/2
+    odi = (br - ar)/2;
+    c = cosine[k];
+    s = cosine[quarter-k];
+    tr = (c*odr + s*odi)>>15;          // W^k*O, W^k = c - js
+    ti = (c*odi - s*odr)>>15;
+    z[k] = (((er + tr)/2)&0xFFFF)|(((ei + ti)/2)<<16);
+    if(k != m-k){
+      z[m-k] = (((er - tr)/2)&0xFFFF)|(((ti - ei)/2)<<16);
+    }
+  }
+}
+
+// ******** FFT_Frame ************
+// Add Hop new samples to the frame, window it and transform it
+// The complex bins are left in fft->Out
+// Inputs:  pointer to the analyzer
+//          samples Hop new samples, signed, e.g., (ADC-2048)<<4
+// Outputs: none
+RAMFUNC void FFT_Frame(FFTType *fft, const int16_t *samples){
+  uint32_t size = fft->Size;
+  uint32_t keep = size - fft->Hop;   // overlap with the previous frame
+  int16_t *frame = fft->Frame;
+  const int16_t *w = fft->Window;
+  int32_t *in = fft->In;
+  uint32_t k;
+  if(keep){
+    memmove(frame, &frame[fft->Hop], keep*sizeof(int16_t));
+  }
+  memcpy(&frame[keep], samples, fft->Hop*sizeof(int16_t));
+  if(fft->Twiddle){                  // real path, even samples real, odd imaginary
+    for(k = 0; k < size/2; k++){
+      in[k] = (((frame[2*k]*w[2*k])>>15)&0xFFFF)|
+              (((frame[2*k+1]*w[2*k+1])>>15)<<16);
+    }
+    fft->Kernel(fft->Out, in, size/2);
+    FFT_Split(fft);
+    return;
+  }
+  for(k = 0; k < size; k++){         // real part windowed, imaginary part 0
+    in[k] = ((frame[k]*w[k])>>15)&0xFFFF;
+  }
+  fft->Kernel(fft->Out, in, size);
+}
+
+// ******** FFT_Magnitude ************
+// Magnitude of the first Size/2 bins of the last transform
+// Inputs:  pointer to the analyzer
+//          mag room for Size/2 values, 0 to 46341
+// Outputs: none
+void FFT_Magnitude(FFTType *fft, uint16_t *mag){
+  uint32_t k;
+  int32_t re, im;
+  for(k = 0; k < fft->Size/2; k++){
+    re = (int16_t)fft->Out[k];
+    im = fft->Out[k]>>16;
+    mag[k] = FixMath_Sqrt((uint32_t)(re*re) + (uint32_t)(im*im));
+  }
+}
+
+// ******** FFT_Power ************
+// Squared magnitude of the first Size/2 bins of the last transform
+// Inputs:  pointer to the analyzer
+//          power room for Size/2 values
+// Outputs: none
+void FFT_Power(FFTType *fft, uint32_t *power){
+  uint32_t k;
+  int32_t re, im;
+  for(k = 0; k < fft->Size/2; k++){
+    re = (int16_t)fft->Out[k];
+    im = fft->Out[k]>>16;
+    power[k] = (uint32_t)(re*re) + (uint32_t)(im*im);
+  }
+}
+
+// ******** FFT_Decibels ************
+// Power of the first Size/2 bins of the last transform in 0.1 dB,
+// 10log10(p/2^30) = 3.0103*(log2(p)-30)
+// Inputs:  pointer to the analyzer
+//          db room for Size/2 values, FFT_DB_MIN to 30
+// Outputs: none
+void FFT_Decibels(FFTType *fft, int16_t *db){
+  uint32_t k, p;
+  int32_t re, im, d;
+  for(k = 0; k < fft->Size/2; k++){
+    re = (int16_t)fft->Out[k];
+    im = fft->Out[k]>>16;
+    p = (uint32_t)(re*re) + (uint32_t)(im*im);
+    if(p == 0){
+      db[k] = FFT_DB_MIN;
+    } else{
+      d = FixMath_Db(FixMath_Log2(p) - (30<<16));   // 0.1 dB
+      db[k] = (d < FFT_DB_MIN) ? FFT_DB_MIN : d;
+    }
+  }
+}
+
+// ******** FFT_Spectrum ************
+// Magnitude spectrum of Hop new samples in one call,
+// FFT_Frame followed by FFT_Magnitude
+// Inputs:  pointer to the analyzer
+//          samples Hop new samples
+//          mag room for Size/2 values
+// Outputs: none
+void FFT_Spectrum(FFTType *fft, const int16_t *samples, uint16_t *mag){
+  FFT_Frame(fft, samples);
+  FFT_Magnitude(fft, mag);
+}
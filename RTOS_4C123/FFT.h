@@ -0,0 +1,115 @@
+// FFT.h
+// Runs on LM4F120/TM4C123
+// Spectrum service over the STMicroelectronics radix-4 FFT kernels,
+// cr4_fft_64_stm32, cr4_fft_256_stm32 and cr4_fft_1024_stm32.
+// It picks the kernel by size, windows the samples while packing
+// them into the complex input, and turns the result into magnitude,
+// power or decibel spectra with integer math only.  Frames may
+// overlap, each spectrum then needs only Hop new samples.
+// EE445M Lab 2
+
+// The kernels scale their output by 1/Size, so a bin is the average
+// of the windowed samples times the complex exponential, and a sine
+// of amplitude A lands in its bin with magnitude A/2 times the
+// coherent gain of the window, 1 rectangular, 0.5 Hann, 0.42 Blackman.
+// All ADC data is real, so FFT_InitReal is the usual choice, it gets
+// twice the resolution from the same kernel for a short extra pass.
+
+#ifndef __FFT_H__ // do not include more than once
+#define __FFT_H__
+#include <stdint.h>
+
+// windows
+#define FFT_RECTANGULAR  0
+#define FFT_HANN         1
+#define FFT_BLACKMAN     2
+
+// lowest value FFT_Decibels reports, for an empty bin, in 0.1 dB
+#define FFT_DB_MIN   (-1000)
+
+// one spectrum analyzer, e.g., 64 points with 50% overlap
+//   static int16_t Window[64], Frame[64];
+//   static int32_t In[64], Out[64];
+//   FFT_Init(&fft, 64, FFT_HANN, 32, Window, Frame, In, Out);
+struct FFT{
+  uint32_t Size;           // 64, 256 or 1024 points
+  uint32_t Hop;            // new samples per spectrum, Size for no overlap
+  int16_t *Window;         // Size taps in Q15
+  int16_t *Frame;          // last Size samples, oldest first
+  int32_t *In;             // Size complex values, real in the low half,
+                           // Size/2 in and out for the real path
+  int32_t *Out;            // Size complex bins, real in the low half
+  int16_t *Twiddle;        // cos of a quarter wave, real path only, else 0
+  void (*Kernel)(void *pssOUT, void *pssIN, unsigned short Nbin);
+};
+typedef struct FFT FFTType;
+
+// ******** FFT_Init ************
+// Set up a spectrum analyzer, build its window and clear its frame
+// Inputs:  pointer to the analyzer
+//          size 64, 256 or 1024
+//          window FFT_RECTANGULAR, FFT_HANN or FFT_BLACKMAN
+//          hop new samples per spectrum, 1 to size
+//          windowBuf, frame size samples each
+//          in, out size words each, out must not be in
+// Outputs: 1 if successful, 0 on a bad size, window or hop
+int FFT_Init(FFTType *fft, uint32_t size, uint32_t window, uint32_t hop,
+             int16_t *windowBuf, int16_t *frame, int32_t *in, int32_t *out);
+
+// ******** FFT_InitReal ************
+// Set up a spectrum analyzer for real samples, which packs size
+// samples as size/2 complex values for the half size kernel, so it
+// costs about the same as FFT_Init with half the size
+// Inputs:  pointer to the analyzer
+//          size 128, 512 or 2048
+//          window FFT_RECTANGULAR, FFT_HANN or FFT_BLACKMAN
+//          hop new samples per spectrum, 1 to size
+//          windowBuf, frame size samples each
+//          in, out size/2 words each, out must not be in
+//          twiddle size/4+1 values
+// Outputs: 1 if successful, 0 on a bad size, window or hop
+int FFT_InitReal(FFTType *fft, uint32_t size, uint32_t window, uint32_t hop,
+                 int16_t *windowBuf, int16_t *frame, int32_t *in, int32_t *out,
+                 int16_t *twiddle);
+
+// ******** FFT_Frame ************
+// Add Hop new samples to the frame, window it and transform it
+// The complex bins are left in fft->Out
+// Inputs:  pointer to the analyzer
+//          samples Hop new samples, signed, e.g., (ADC-2048)<<4
+// Outputs: none
+void FFT_Frame(FFTType *fft, const int16_t *samples);
+
+// ******** FFT_Magnitude ************
+// Magnitude of the first Size/2 bins of the last transform
+// Inputs:  pointer to the analyzer
+//          mag room for Size/2 values, 0 to 46341
+// Outputs: none
+void FFT_Magnitude(FFTType *fft, uint16_t *mag);
+
+// ******** FFT_Power ************
+// Squared magnitude of the first Size/2 bins of the last transform
+// Inputs:  pointer to the analyzer
+//          power room for Size/2 values
+// Outputs: none
+void FFT_Power(FFTType *fft, uint32_t *power);
+
+// ******** FFT_Decibels ************
+// Power of the first Size/2 bins of the last transform in 0.1 dB,
+// 0 dB is a bin of magnitude 32768, so a full scale sine reads
+// about -60 with the rectangular window
+// Inputs:  pointer to the analyzer
+//          db room for Size/2 values, FFT_DB_MIN to 30
+// Outputs: none
+void FFT_Decibels(FFTType *fft, int16_t *db);
+
+// ******** FFT_Spectrum ************
+// Magnitude spectrum of Hop new samples in one call,
+// FFT_Frame followed by FFT_Magnitude
+// Inputs:  pointer to the analyzer
+//          samples Hop new samples
+//          mag room for Size/2 values
+// Outputs: none
+void FFT_Spectrum(FFTType *fft, const int16_t *samples, uint16_t *mag);
+
+#endif // __FFT_H__
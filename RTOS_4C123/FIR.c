@@ -0,0 +1,165 @@
+// FIR.c
+// Runs on LM4F120/TM4C123
+// Fixed-point FIR filters for blocks of samples.
+// EE445M Lab 2
+
+// The history is kept twice, every input goes into State[i] and
+// State[i+NumTaps], so the last NumTaps inputs are always the
+// contiguous window State[Index] to State[Index+NumTaps-1], oldest
+// first, and the inner loop needs no modulo or wrap test.
+// The taps are stored reversed, so tap pairs and window pairs line
+// up and one SMLALD does two multiply-accumulates into 64 bits.
+// The window moves one sample per input, so half the time it starts
+// on an odd halfword; the Cortex-M4 does unaligned word loads in
+// hardware, which is why the window is read through __packed.
+
+#include <stdint.h>
+#include "RamFunc.h"
+#include "FIR.h"
+
+// copy the input into both halves of the history,
+// returns the window ending with that input
+static __inline const int16_t *FIR_Push(FIRQ15Type *f, int16_t x){
+  uint32_t i = f->Index;
+  f->State[i] = x;
+  f->State[i+f->NumTaps] = x;
+  i++;
+  if(i == f->NumTaps){
+    i = 0;
+  }
+  f->Index = i;
+  return &f->State[i];
+}
+
+// sum of pairs*2 products of taps and window, saturated to Q15
+static __inline int32_t FIR_Dot(const int16_t *taps, const int16_t *window, uint32_t pairs){
+  const int32_t *c = (const int32_t *)taps;          // word aligned
+  const __packed int32_t *x = (const __packed int32_t *)window;
+  int64_t acc = 0;
+  do{
+    acc = __smlald(*c++, *x++, acc);
+  }while(--pairs);
+  acc = acc>>15;
+  if(acc > 32767){
+    return 32767;
+  } else if(acc < -32768){
+    return -32768;
+  }
+  return (int32_t)acc;
+}
+
+// ******** FIR_Q15Init ************
+// Set up a plain or decimating filter and clear its history
+// Inputs:  pointer to the filter
+//          h numTaps taps in Q15, h[0] multiplies the newest input
+//          numTaps even, 2 or more
+//          factor 1 for one output per input, M for one per M inputs
+//          coeffs numTaps/2 words for the taps in filter order
+//          state 2*numTaps samples of history
+// Outputs: 1 if successful, 0 if numTaps is odd or factor is 0
+int FIR_Q15Init(FIRQ15Type *f, const int16_t *h, uint32_t numTaps, uint32_t factor,
+                int32_t *coeffs, int16_t *state){
+  int16_t *c = (int16_t *)coeffs;
+  uint32_t i;
+  if((numTaps < 2) || (numTaps&1) || (factor == 0)){
+    return 0;
+  }
+  for(i = 0; i < numTaps; i++){
+    c[i] = h[numTaps-1-i];             // oldest input first
+  }
+  for(i = 0; i < 2*numTaps; i++){
+    state[i] = 0;
+  }
+  f->NumTaps = numTaps;
+  f->Coeffs = c;
+  f->State = state;
+  f->Index = 0;
+  f->Factor = factor;
+  f->Phase = 0;
+  return 1;
+}
+
+// ******** FIR_Q15InitInterpolate ************
+// Set up an interpolating filter and clear its history
+// Output nL+p is the sum over k of h[kL+p]*x[n-k], so phase p
+// uses every Lth tap starting at p, numTaps/L taps per output
+// Inputs:  pointer to the filter
+//          h numTaps taps in Q15, h[0] multiplies the newest input
+//          numTaps a multiple of 2*factor
+//          factor L, outputs per input
+//          coeffs numTaps/2 words for the polyphase taps
+//          state 2*numTaps/factor samples of history
+// Outputs: 1 if successful, 0 on a bad numTaps or factor
+int FIR_Q15InitInterpolate(FIRQ15Type *f, const int16_t *h, uint32_t numTaps, uint32_t factor,
+                           int32_t *coeffs, int16_t *state){
+  int16_t *c = (int16_t *)coeffs;
+  uint32_t taps, p, i;
+  if((factor == 0) || (numTaps == 0) || (numTaps%(2*factor))){
+    return 0;
+  }
+  taps = numTaps/factor;               // per phase
+  for(p = 0; p < factor; p++){
+    for(i = 0; i < taps; i++){
+      c[p*taps+i] = h[(taps-1-i)*factor+p];
+    }
+  }
+  for(i = 0; i < 2*taps; i++){
+    state[i] = 0;
+  }
+  f->NumTaps = taps;
+  f->Coeffs = c;
+  f->State = state;
+  f->Index = 0;
+  f->Factor = factor;
+  f->Phase = 0;
+  return 1;
+}
+
+// ******** FIR_Q15 ************
+// Run a plain or decimating filter over a block, the decimation
+// phase carries over, so n need not be a multiple of the factor
+// Only the inputs that end a group of Factor get an output, the
+// others are just pushed into the history
+// Inputs:  pointer to the filter
+//          in block of n samples
+//          out room for n/Factor+1 samples, may be the same as in
+//          n number of input samples
+// Outputs: number of output samples written
+RAMFUNC uint32_t FIR_Q15(FIRQ15Type *f, const int16_t *in, int16_t *out, uint32_t n){
+  const int16_t *window;
+  uint32_t pairs = f->NumTaps/2;
+  uint32_t i, count = 0;
+  for(i = 0; i < n; i++){
+    window = FIR_Push(f, in[i]);
+    f->Phase++;
+    if(f->Phase == f->Factor){
+      f->Phase = 0;
+      out[count] = FIR_Dot(f->Coeffs, window, pairs);  // in[i] already read
+      count++;
+    }
+  }
+  return count;
+}
+
+// ******** FIR_Q15Interpolate ************
+// Run an interpolating filter over a block
+// Inputs:  pointer to the filter
+//          in block of n samples
+//          out room for n*Factor samples, not the same as in
+//          n number of input samples
+// Outputs: number of output samples written, n*Factor
+RAMFUNC uint32_t FIR_Q15Interpolate(FIRQ15Type *f, const int16_t *in, int16_t *out, uint32_t n){
+  const int16_t *window;
+  const int16_t *taps;
+  uint32_t pairs = f->NumTaps/2;
+  uint32_t i, p;
+  for(i = 0; i < n; i++){
+    window = FIR_Push(f, in[i]);
+    taps = f->Coeffs;
+    for(p = 0; p < f->Factor; p++){
+      *out++ = FIR_Dot(taps, window, pairs);
+      taps += f->NumTaps;
+    }
+  }
+  return n*f->Factor;
+}
@@ -0,0 +1,77 @@
+// FIR.h
+// Runs on LM4F120/TM4C123
+// Fixed-point FIR filters for blocks of samples, e.g., frames from
+// the frame channel.  Plain and decimating filters compute one
+// output per input or one per Factor inputs; interpolating filters
+// compute Factor outputs per input with a polyphase split, so no
+// time is spent on the zeros of the upsampled signal.
+// EE445M Lab 2
+
+// Samples and taps are Q15 and the sum of products is 64 bits, so
+// up to 65536 taps of full scale cannot overflow before the output
+// is saturated.  The inner loop is one SMLALD per two taps, two taps
+// times two samples per instruction, on a contiguous window of the
+// history (see FIR.c).  main16 in Lab2.c prints the cycles per tap
+// measured on the board for 32, 64 and 128 taps.
+
+#ifndef __FIR_H__ // do not include more than once
+#define __FIR_H__
+#include <stdint.h>
+
+// one filter, set up with FIR_Q15Init or FIR_Q15InitInterpolate
+struct FIRQ15{
+  uint32_t NumTaps;        // taps per output, even
+  const int16_t *Coeffs;   // reversed taps, one set per interpolation phase
+  int16_t *State;          // last NumTaps inputs, twice
+  uint32_t Index;          // next input goes here, 0 to NumTaps-1
+  uint32_t Factor;         // decimation or interpolation ratio, 1 for none
+  uint32_t Phase;          // inputs since the last decimated output
+};
+typedef struct FIRQ15 FIRQ15Type;
+
+// ******** FIR_Q15Init ************
+// Set up a plain or decimating filter and clear its history
+// Inputs:  pointer to the filter
+//          h numTaps taps in Q15, h[0] multiplies the newest input
+//          numTaps even, 2 or more
+//          factor 1 for one output per input, M for one per M inputs
+//          coeffs numTaps/2 words for the taps in filter order
+//          state 2*numTaps samples of history
+// Outputs: 1 if successful, 0 if numTaps is odd or factor is 0
+int FIR_Q15Init(FIRQ15Type *f, const int16_t *h, uint32_t numTaps, uint32_t factor,
+                int32_t *coeffs, int16_t *state);
+
+// ******** FIR_Q15InitInterpolate ************
+// Set up an interpolating filter and clear its history
+// The taps are those of the lowpass at the output rate, with a
+// passband gain of factor to make up for the inserted zeros.
+// Inputs:  pointer to the filter
+//          h numTaps taps in Q15, h[0] multiplies the newest input
+//          numTaps a multiple of 2*factor
+//          factor L, outputs per input
+//          coeffs numTaps/2 words for the polyphase taps
+//          state 2*numTaps/factor samples of history
+// Outputs: 1 if successful, 0 on a bad numTaps or factor
+int FIR_Q15InitInterpolate(FIRQ15Type *f, const int16_t *h, uint32_t numTaps, uint32_t factor,
+                           int32_t *coeffs, int16_t *state);
+
+// ******** FIR_Q15 ************
+// Run a plain or decimating filter over a block, the decimation
+// phase carries over, so n need not be a multiple of the factor
+// Inputs:  pointer to the filter
+//          in block of n samples
+//          out room for n/Factor+1 samples, may be the same as in
+//          n number of input samples
+// Outputs: number of output samples written
+uint32_t FIR_Q15(FIRQ15Type *f, const int16_t *in, int16_t *out, uint32_t n);
+
+// ******** FIR_Q15Interpolate ************
+// Run an interpolating filter over a block
+// Inputs:  pointer to the filter
+//          in block of n samples
+//          out room for n*Factor samples, not the same as in
+//          n number of input samples
+// Outputs: number of output samples written, n*Factor
+uint32_t FIR_Q15Interpolate(FIRQ15Type *f, const int16_t *in, int16_t *out, uint32_t n);
+
+#endif // __FIR_H__
@@ -0,0 +1,308 @@
+// FixMath.c
+// Runs on LM4F120/TM4C123
+// Fixed-point math with interpolated lookup tables, CLZ and CORDIC.
+// EE445M Lab 2
+
+// The tables below are pasted from tools/FixMathTables, which also
+// prints the worst interpolation error of each one.
+// Sine keeps a quarter wave, the other three quarters are mirror
+// images, and interpolation runs on the 22 bits below the index.
+// Log2 takes the integer part from CLZ and interpolates the fraction
+// on the 23 bits below the top byte of the normalized mantissa.
+// The square root normalizes by an even shift so the top byte is 64
+// to 255, where the table guess is within 1/256.  One Newton step,
+// r = (r + m/r)/2, squares that error, good to half a count before
+// the shift back, and the last check makes the floor exact.
+// CORDIC rotates the vector onto the x axis by +-atan(2^-i) and adds
+// up the angles.  Its gain of 1.647 and the 2^28 scale keep x and y
+// inside 32 bits.
+
+#include <stdint.h>
+#include "RamFunc.h"
+#include "FixMath.h"
+
+#define FIXMATH_SINSIZE  256   // segments in a quarter wave
+#define FIXMATH_LOGSIZE  256   // segments in one octave
+#define FIXMATH_CORDIC   24    // CORDIC steps
+#define FIXMATH_SQRTMIN  64    // smallest top byte after normalizing
+
+// sin(pi/2*i/256) in Q30, from tools/FixMathTables
+static const int32_t SinQuarter[257] = {
+  0, 6588356, 13176464, 19764076, 26350943, 32936819,
+  39521455, 46104602, 52686014, 59265442, 65842639, 72417357,
+  78989349, 85558366, 92124163, 98686491, 105245103, 111799753,
+  118350194, 124896179, 131437462, 137973796, 144504935, 151030634,
+  157550647, 164064728, 170572633, 177074115, 183568930, 190056834,
+  196537583, 203010932, 209476638, 215934457, 222384147, 228825464,
+  235258165, 241682010, 248096755, 254502159, 260897982, 267283981,
+  273659918, 280025552, 286380643, 292724951, 299058239, 305380268,
+  311690799, 317989595, 324276419, 330551034, 336813204, 343062693,
+  349299266, 355522689, 361732726, 367929144, 374111709, 380280190,
+  386434353, 392573967, 398698801, 404808624, 410903207, 416982319,
+  423045732, 429093217, 435124548, 441139496, 447137835, 453119340,
+  459083786, 465030947, 470960600, 476872522, 482766489, 488642281,
+  494499676, 500338453, 506158392, 511959275, 517740883, 523502998,
+  529245404, 534967884, 540670223, 546352205, 552013618, 557654248,
+  563273883, 568872310, 574449320, 580004702, 585538248, 591049748,
+  596538995, 602005783, 607449906, 612871159, 618269338, 623644239,
+  628995660, 634323400, 639627258, 644907034, 650162530, 655393548,
+  660599890, 665781362, 670937767, 676068911, 681174602, 686254647,
+  691308855, 696337036, 701339000, 706314559, 711263525, 716185713,
+  721080937, 725949013, 730789757, 735602987, 740388522, 745146182,
+  749875788, 754577161, 759250125, 763894504, 768510122, 773096806,
+  777654384, 782182683, 786681534, 791150767, 795590213, 799999706,
+  804379079, 808728167, 813046808, 817334838, 821592095, 825818421,
+  830013654, 834177638, 838310216, 842411232, 846480531, 850517961,
+  854523370, 858496606, 862437520, 866345964, 870221790, 874064853,
+  877875009, 881652112, 885396022, 889106597, 892783698, 896427186,
+  900036924, 903612776, 907154608, 910662286, 914135678, 917574653,
+  920979082, 924348837, 927683790, 930983817, 934248793, 937478595,
+  940673101, 943832191, 946955747, 950043650, 953095785, 956112036,
+  959092290, 962036435, 964944360, 967815955, 970651112, 973449725,
+  976211688, 978936898, 981625251, 984276646, 986890984, 989468165,
+  992008094, 994510675, 996975812, 999403415, 1001793390, 1004145648,
+  1006460100, 1008736660, 1010975242, 1013175761, 1015338134, 1017462281,
+  1019548121, 1021595575, 1023604567, 1025575020, 1027506862, 1029400018,
+  1031254418, 1033069992, 1034846671, 1036584389, 1038283080, 1039942680,
+  1041563127, 1043144360, 1044686319, 1046188946, 1047652185, 1049075980,
+  1050460278, 1051805027, 1053110176, 1054375676, 1055601479, 1056787540,
+  1057933813, 1059040255, 1060106826, 1061133483, 1062120190, 1063066909,
+  1063973603, 1064840240, 1065666786, 1066453210, 1067199483, 1067905576,
+  1068571464, 1069197120, 1069782521, 1070327646, 1070832474, 1071296985,
+  1071721163, 1072104991, 1072448455, 1072751542, 1073014240, 1073236540,
+  1073418433, 1073559913, 1073660973, 1073721611, 1073741824
+};
+// log2(1+i/256) in Q16, from tools/FixMathTables
+static const uint32_t Log2Frac[257] = {
+  0, 369, 736, 1102, 1466, 1829,
+  2190, 2551, 2909, 3267, 3623, 3978,
+  4331, 4683, 5034, 5384, 5732, 6079,
+  6425, 6769, 7112, 7454, 7795, 8134,
+  8473, 8810, 9146, 9480, 9814, 10146,
+  10477, 10807, 11136, 11464, 11791, 12116,
+  12440, 12764, 13086, 13407, 13727, 14046,
+  14363, 14680, 14996, 15310, 15624, 15937,
+  16248, 16559, 16868, 17177, 17484, 17791,
+  18096, 18401, 18704, 19007, 19308, 19609,
+  19909, 20207, 20505, 20802, 21098, 21393,
+  21687, 21980, 22272, 22564, 22854, 23144,
+  23433, 23720, 24007, 24293, 24579, 24863,
+  25146, 25429, 25711, 25992, 26272, 26551,
+  26830, 27108, 27384, 27660, 27936, 28210,
+  28484, 28757, 29029, 29300, 29571, 29840,
+  30109, 30378, 30645, 30912, 31178, 31443,
+  31707, 31971, 32234, 32496, 32758, 33019,
+  33279, 33538, 33797, 34055, 34312, 34569,
+  34825, 35080, 35334, 35588, 35841, 36094,
+  36346, 36597, 36847, 37097, 37346, 37595,
+  37842, 38090, 38336, 38582, 38827, 39072,
+  39316, 39559, 39802, 40044, 40286, 40527,
+  40767, 41006, 41246, 41484, 41722, 41959,
+  42196, 42432, 42667, 42902, 43137, 43370,
+  43603, 43836, 44068, 44300, 44530, 44761,
+  44990, 45220, 45448, 45676, 45904, 46131,
+  46357, 46583, 46809, 47034, 47258, 47482,
+  47705, 47928, 48150, 48372, 48593, 48813,
+  49034, 49253, 49472, 49691, 49909, 50127,
+  50344, 50560, 50776, 50992, 51207, 51422,
+  51636, 51850, 52063, 52276, 52488, 52700,
+  52911, 53122, 53332, 53542, 53751, 53960,
+  54169, 54377, 54584, 54791, 54998, 55204,
+  55410, 55615, 55820, 56025, 56229, 56432,
+  56635, 56838, 57040, 57242, 57443, 57644,
+  57845, 58045, 58245, 58444, 58643, 58841,
+  59039, 59237, 59434, 59631, 59827, 60023,
+  60219, 60414, 60609, 60803, 60997, 61190,
+  61384, 61576, 61769, 61961, 62152, 62343,
+  62534, 62725, 62915, 63104, 63294, 63483,
+  63671, 63859, 64047, 64234, 64421, 64608,
+  64794, 64980, 65166, 65351, 65536
+};
+// atan(2^-i), 2^32 per turn, from tools/FixMathTables
+static const int32_t AtanTable[24] = {
+  536870912, 316933406, 167458907, 85004756, 42667331, 21354465,
+  10679838, 5340245, 2670163, 1335087, 667544, 333772,
+  166886, 83443, 41722, 20861, 10430, 5215,
+  2608, 1304, 652, 326, 163, 81
+};
+// sqrt((i+0.5)*2^24) for top bytes i = 64 to 255, from tools/FixMathTables
+static const uint16_t SqrtGuess[192] = {
+  32896, 33150, 33402, 33652, 33900, 34147,
+  34392, 34635, 34876, 35116, 35354, 35590,
+  35825, 36059, 36291, 36521, 36750, 36978,
+  37204, 37429, 37652, 37874, 38095, 38315,
+  38533, 38750, 38966, 39181, 39394, 39606,
+  39818, 40028, 40237, 40445, 40652, 40857,
+  41062, 41266, 41469, 41671, 41871, 42071,
+  42270, 42468, 42665, 42861, 43057, 43251,
+  43445, 43637, 43829, 44020, 44210, 44400,
+  44588, 44776, 44963, 45149, 45334, 45519,
+  45703, 45886, 46069, 46250, 46431, 46612,
+  46791, 46970, 47149, 47326, 47503, 47679,
+  47855, 48030, 48204, 48378, 48551, 48723,
+  48895, 49067, 49237, 49407, 49577, 49746,
+  49914, 50082, 50249, 50416, 50582, 50747,
+  50912, 51077, 51241, 51404, 51567, 51730,
+  51892, 52053, 52214, 52374, 52534, 52694,
+  52853, 53011, 53169, 53327, 53484, 53640,
+  53797, 53952, 54108, 54262, 54417, 54571,
+  54724, 54877, 55030, 55182, 55334, 55485,
+  55636, 55787, 55937, 56087, 56236, 56385,
+  56534, 56682, 56830, 56977, 57124, 57271,
+  57417, 57563, 57709, 57854, 57999, 58143,
+  58287, 58431, 58574, 58717, 58860, 59002,
+  59144, 59286, 59427, 59568, 59709, 59849,
+  59989, 60129, 60268, 60407, 60546, 60684,
+  60822, 60960, 61098, 61235, 61372, 61508,
+  61644, 61780, 61916, 62051, 62186, 62321,
+  62456, 62590, 62724, 62857, 62991, 63124,
+  63256, 63389, 63521, 63653, 63785, 63916,
+  64047, 64178, 64309, 64439, 64569, 64699,
+  64828, 64957, 65086, 65215, 65344, 65472
+};
+
+// ******** FixMath_Sin ************
+// Sine from a 257 entry quarter wave, linearly interpolated
+// Inputs:  angle 2^32 per turn
+// Outputs: sin(angle) in Q30, -2^30 to 2^30
+RAMFUNC int32_t FixMath_Sin(uint32_t angle){
+  uint32_t quadrant = angle>>30;
+  uint32_t x = angle&0x3FFFFFFF;     // within the quadrant
+  uint32_t i, frac;
+  int32_t s;
+  if(quadrant&1){                    // falling half of the hump
+    x = FIXMATH_QUARTER - x;
+    if(x == FIXMATH_QUARTER){        // exactly 90 or 270 degrees
+      return (quadrant&2) ? -FIXMATH_Q30 : FIXMATH_Q30;
+    }
+  }
+  i = x>>22;
+  frac = x&0x3FFFFF;
+  s = SinQuarter[i] + (int32_t)(((int64_t)(SinQuarter[i+1]-SinQuarter[i])*frac)>>22);
+  return (quadrant&2) ? -s : s;
+}
+
+// ******** FixMath_Cos ************
+// Cosine, the sine a quarter turn later
+// Inputs:  angle 2^32 per turn
+// Outputs: cos(angle) in Q30, -2^30 to 2^30
+RAMFUNC int32_t FixMath_Cos(uint32_t angle){
+  return FixMath_Sin(angle + FIXMATH_QUARTER);
+}
+
+// ******** FixMath_Sqrt ************
+// Integer square root, table guess, one Newton step, final check
+// Inputs:  x 0 to 4294967295
+// Outputs: floor(sqrt(x)), 0 to 65535
+RAMFUNC uint32_t FixMath_Sqrt(uint32_t x){
+  uint32_t shift, m, r;
+  if(x == 0){
+    return 0;
+  }
+  shift = __clz(x)&~1;               // even, so the root shifts by half
+  m = x<<shift;                      // 2^30 to 2^32-1
+  r = SqrtGuess[(m>>24) - FIXMATH_SQRTMIN];
+  r = (r + m/r)>>1;                  // Newton, within a count of sqrt(m)
+  if(r > 0xFFFF){
+    r = 0xFFFF;
+  }
+  r >>= shift/2;
+  if(r*r > x){
+    r--;
+  } else if((r < 0xFFFF) && ((r+1)*(r+1) <= x)){
+    r++;
+  }
+  return r;
+}
+
+// ******** FixMath_Sqrt64 ************
+// Integer square root of a 64-bit number, one result bit per step
+// Inputs:  x
+// Outputs: floor(sqrt(x)), 0 to 4294967295
+uint32_t FixMath_Sqrt64(uint64_t x){
+  uint64_t root = 0;
+  uint64_t bit;
+  uint32_t hi = (uint32_t)(x>>32);
+  if(hi == 0){
+    return FixMath_Sqrt((uint32_t)x);
+  }
+  bit = 1ULL<<(62 - (__clz(hi)&~1));  // highest power of 4 <= x
+  while(bit){
+    if(x >= root + bit){
+      x -= root + bit;
+      root = (root>>1) + bit;
+    } else{
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+// ******** FixMath_Log2 ************
+// Base 2 logarithm, CLZ plus an interpolated table of the fraction
+// Inputs:  x 1 to 4294967295
+// Outputs: log2(x) in Q16, FIXMATH_LOG2_ZERO for 0
+RAMFUNC int32_t FixMath_Log2(uint32_t x){
+  uint32_t shift, m, i, frac;
+  if(x == 0){
+    return FIXMATH_LOG2_ZERO;
+  }
+  shift = __clz(x);
+  m = x<<shift;                      // top bit set
+  i = (m>>23)&0xFF;                  // next eight bits
+  frac = m&0x7FFFFF;                 // and the rest, 23 bits
+  return ((31-(int32_t)shift)<<16) + Log2Frac[i] +
+         (((Log2Frac[i+1]-Log2Frac[i])*frac + (1<<22))>>23);
+}
+
+// ******** FixMath_Db ************
+// Decibels of a power ratio from its log2
+// Inputs:  log2 of the ratio in Q16
+// Outputs: 10log10 of the ratio in 0.1 dB, rounded
+int32_t FixMath_Db(int32_t log2){
+  return (int32_t)(((int64_t)log2*123302 + (1<<27))>>28);  // 30.103/65536 in Q28
+}
+
+// ******** FixMath_Atan2 ************
+// Angle of the point (x,y), CORDIC in vectoring mode
+// Inputs:  y x any values, both 0 gives 0
+// Outputs: angle 2^32 per turn, -2^31 to 2^31-1 is -pi to pi
+RAMFUNC int32_t FixMath_Atan2(int32_t y, int32_t x){
+  uint32_t ax = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+  uint32_t ay = (y < 0) ? -(uint32_t)y : (uint32_t)y;
+  uint32_t angle, i, shift;
+  int32_t xs, ys, t;
+  if((ax|ay) == 0){
+    return 0;
+  }
+  shift = __clz(ax|ay);              // larger magnitude to 2^28
+  if(shift >= 3){
+    ax <<= shift-3;
+    ay <<= shift-3;
+  } else{
+    ax >>= 3-shift;
+    ay >>= 3-shift;
+  }
+  xs = (x < 0) ? -(int32_t)ax : (int32_t)ax;
+  ys = (y < 0) ? -(int32_t)ay : (int32_t)ay;
+  angle = 0;
+  if(xs < 0){                        // left half, turn by 180 degrees
+    xs = -xs;
+    ys = -ys;
+    angle = 0x80000000;
+  }
+  for(i = 0; i < FIXMATH_CORDIC; i++){
+    t = xs;
+    if(ys > 0){                      // rotate clockwise
+      xs += ys>>i;
+      ys -= t>>i;
+      angle += AtanTable[i];
+    } else{
+      xs -= ys>>i;
+      ys += t>>i;
+      angle -= AtanTable[i];
+    }
+  }
+  return (int32_t)angle;
+}
@@ -0,0 +1,76 @@
+// FixMath.h
+// Runs on LM4F120/TM4C123
+// Fixed-point math without the FPU or libm, sine and cosine, square
+// root, log2 and decibels, and atan2, for spectral, filter and
+// controller code that needs them in hot paths.  The lookup tables
+// come from tools/FixMathTables and are interpolated, CLZ does the
+// normalization, and atan2 is CORDIC.
+// EE445M Lab 2
+
+// Angles are binary, 2^32 per turn, so they wrap for free, e.g.,
+// phase += (f<<32)/fs is an oscillator, 0x40000000 is 90 degrees.
+// Error bounds are over the whole input range, checked on the host
+// against libm.  Cycle counts are estimates from the instructions,
+// the interpreter's math command measures them on the board.
+//   FixMath_Sin/Cos    |error| < 5e-6, 0.16 Q15 counts  ~25 cycles
+//   FixMath_Sqrt       exact floor                       ~45 cycles
+//   FixMath_Sqrt64     exact floor, 2^32 and up          ~300 cycles
+//   FixMath_Log2       |error| <= 1 Q16 count, 1.6e-5    ~25 cycles
+//   FixMath_Atan2      |error| < 2e-7 rad, 100 counts    ~220 cycles
+
+#ifndef __FIXMATH_H__ // do not include more than once
+#define __FIXMATH_H__
+#include <stdint.h>
+
+#define FIXMATH_Q30        0x40000000   // 1.0 for FixMath_Sin and FixMath_Cos
+#define FIXMATH_QUARTER    0x40000000   // 90 degrees as an angle
+#define FIXMATH_LOG2_ZERO  ((int32_t)0x80000000)  // FixMath_Log2(0)
+
+// ******** FixMath_Sin ************
+// Sine from a 257 entry quarter wave, linearly interpolated
+// Inputs:  angle 2^32 per turn
+// Outputs: sin(angle) in Q30, -2^30 to 2^30
+int32_t FixMath_Sin(uint32_t angle);
+
+// ******** FixMath_Cos ************
+// Cosine, the sine a quarter turn later
+// Inputs:  angle 2^32 per turn
+// Outputs: cos(angle) in Q30, -2^30 to 2^30
+int32_t FixMath_Cos(uint32_t angle);
+
+// ******** FixMath_Sqrt ************
+// Integer square root, a table guess on the top byte after
+// normalizing with CLZ, one Newton step and a final check
+// Inputs:  x 0 to 4294967295
+// Outputs: floor(sqrt(x)), 0 to 65535
+uint32_t FixMath_Sqrt(uint32_t x);
+
+// ******** FixMath_Sqrt64 ************
+// Integer square root of a 64-bit number, one result bit per step
+// starting at the top set bit
+// Inputs:  x
+// Outputs: floor(sqrt(x)), 0 to 4294967295
+uint32_t FixMath_Sqrt64(uint64_t x);
+
+// ******** FixMath_Log2 ************
+// Base 2 logarithm, the bit position from CLZ plus a 257 entry
+// table of the fraction, linearly interpolated
+// Inputs:  x 1 to 4294967295
+// Outputs: log2(x) in Q16, 0 to 2097151, FIXMATH_LOG2_ZERO for 0
+int32_t FixMath_Log2(uint32_t x);
+
+// ******** FixMath_Db ************
+// Decibels of a power ratio from its log2, 10log10(p) = 3.0103log2(p),
+// e.g., FixMath_Db(FixMath_Log2(p) - FixMath_Log2(ref))
+// Inputs:  log2 of the ratio in Q16
+// Outputs: 10log10 of the ratio in 0.1 dB, rounded
+int32_t FixMath_Db(int32_t log2);
+
+// ******** FixMath_Atan2 ************
+// Angle of the point (x,y), CORDIC in vectoring mode, 24 steps
+// after scaling the larger of |x| and |y| to 2^28
+// Inputs:  y x any values, both 0 gives 0
+// Outputs: angle 2^32 per turn, -2^31 to 2^31-1 is -pi to pi
+int32_t FixMath_Atan2(int32_t y, int32_t x);
+
+#endif // __FIXMATH_H__
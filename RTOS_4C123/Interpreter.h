@@ -34,6 +34,10 @@
 #include "OS.h"
 #include "ST7735TestResources.h"
 #include "ADCT0ATrigger.h"
+#include "Seqlock.h"
+#include "Tone.h"
+#include "Stats.h"
+#include "FixMath.h"
 
 
 void DisableInterrupts(void); // Disable interrupts
@@ -44,6 +48,22 @@ void WaitForInterrupt(void);  // low power mode
 
 unsigned short buf[BUFFERSIZE];
 
+// performance measures, defined in Lab2.c
+extern unsigned long NumCreated;
+extern unsigned long PIDWork;
+extern short Actuator;
+extern RWLockType PIDLock;
+extern unsigned long DataLost;
+extern unsigned long FilterWork;
+extern long MaxJitter;
+extern unsigned long JitterHistogram[];
+extern unsigned long const JitterSize;
+extern SeqLockType DASSeq;
+extern unsigned long Mains[];
+extern GoertzelType Hum;
+extern StatsType DASStats;
+extern StatsType ProducerStats;
+
 //---------------------UART_NewLine---------------------
 // Output a CR,LF to UART to go to a new line
 // Input: none
@@ -65,6 +85,18 @@ void print_help() {
 	UART_NewLine();
 	UART_OutString("gtest : Runs a graphics test");
 	UART_NewLine();
+	UART_OutString("mem : Prints memory pool usage");
+	UART_NewLine();
+	UART_OutString("load : Prints CPU load over 1, 10 and 60 s");
+	UART_NewLine();
+	UART_OutString("stats : Prints thread and PID performance measures");
+	UART_NewLine();
+	UART_OutString("jitter : Prints the DAS jitter histogram");
+	UART_NewLine();
+	UART_OutString("sig : Prints mean, deviation, RMS, min and max of the ADC inputs");
+	UART_NewLine();
+	UART_OutString("math : Prints the cycles per call of the FixMath functions");
+	UART_NewLine();
 }
 
 void print_prompt() {
@@ -107,30 +139,220 @@ int check_string(char* strptr) {
 	           strptr[2] == 'l' && 
 	           strptr[3] == 'p') {
 		retv = 6;
+	} else if (strptr[0] == 'm' && 
+		         strptr[1] == 'e' && 
+	           strptr[2] == 'm') {
+		retv = 8;
+	} else if (strptr[0] == 'l' && 
+		         strptr[1] == 'o' && 
+	           strptr[2] == 'a' && 
+	           strptr[3] == 'd') {
+		retv = 9;
+	} else if (strptr[0] == 's' && 
+		         strptr[1] == 't' && 
+	           strptr[2] == 'a' && 
+	           strptr[3] == 't' && 
+	           strptr[4] == 's') {
+		retv = 10;
+	} else if (strptr[0] == 'j' && 
+		         strptr[1] == 'i' && 
+	           strptr[2] == 't') {
+		retv = 11;
+	} else if (strptr[0] == 's' && 
+		         strptr[1] == 'i' && 
+	           strptr[2] == 'g') {
+		retv = 12;
+	} else if (strptr[0] == 'm' && 
+		         strptr[1] == 'a' && 
+	           strptr[2] == 't' && 
+	           strptr[3] == 'h') {
+		retv = 13;
 	} else {
 		retv = 0;
 	}
 	return retv;
 }
 
+// burst of BUFFERSIZE samples on PB5 at 1 kHz, sleeps until done
 void print_adc(char* string) {
-	/*for(int i = 0; i < 1000; i++) {
-		sprintf(string, "%u ", ADC_In());
+	if(OS_ADC_Collect(11, 1000, buf, BUFFERSIZE) == 0) {
+		UART_OutString("ADC busy");
+		return;
+	}
+	OS_ADC_Wait();
+	for(int i = 0; i < BUFFERSIZE; i++) {
+		sprintf(string, "%u ", buf[i]);
 		UART_OutString(string);
 		if(i % 10 == 9) {
 			UART_NewLine();
 		}
 	}
-	ADC_Collect(11, 1000, buf, BUFFERSIZE);
-	while(ADC_Stop() != 0) {
-	}
-	for(int i = 0; i < BUFFERSIZE; i++) {
-		sprintf(string, "%u ", buf[i]);
+}
+
+void print_mem(char* string) {
+	MemPoolStatsType stats;
+	for(uint32_t i = 0; MemPool_Stats(i, &stats); i++) {
+		sprintf(string, "%u B x%u", stats.BlockSize, stats.NumBlocks);
 		UART_OutString(string);
-		if(i % 10 == 9) {
+		sprintf(string, " used=%u", stats.Used);
+		UART_OutString(string);
+		sprintf(string, " max=%u", stats.HighWater);
+		UART_OutString(string);
+		sprintf(string, " fail=%u", stats.Failures);
+		UART_OutString(string);
+		UART_NewLine();
+	}
+}
+
+// load is in 0.1% units
+void print_load(char* string) {
+	uint32_t load;
+	load = OS_CPULoad(1);
+	sprintf(string, "1s=%u.%u%%", load/10, load%10);
+	UART_OutString(string);
+	load = OS_CPULoad(10);
+	sprintf(string, " 10s=%u.%u%%", load/10, load%10);
+	UART_OutString(string);
+	load = OS_CPULoad(60);
+	sprintf(string, " 60s=%u.%u%%", load/10, load%10);
+	UART_OutString(string);
+}
+
+// PIDWork and Actuator are read together under PIDLock so
+// the pair always comes from the same PID iteration, and the
+// DAS counters are copied under DASSeq so the ISR never waits
+void print_stats(char* string) {
+	unsigned long work, filterWork;
+	short actuator;
+	long jitter;
+	unsigned long mains60, mains180;
+	uint32_t seq;
+	do{
+		seq = Seq_ReadBegin(&DASSeq);
+		filterWork = FilterWork;
+		jitter = MaxJitter;
+		mains60 = Mains[0];
+		mains180 = Mains[1];
+	}while(Seq_ReadRetry(&DASSeq, seq));
+	OS_ReadLock(&PIDLock);
+	work = PIDWork;
+	actuator = Actuator;
+	OS_ReadUnlock(&PIDLock);
+	sprintf(string, "threads=%lu", NumCreated);
+	UART_OutString(string);
+	sprintf(string, " PID=%lu", work);
+	UART_OutString(string);
+	sprintf(string, " out=%d", actuator);
+	UART_OutString(string);
+	UART_NewLine();
+	sprintf(string, "lost=%lu", DataLost);
+	UART_OutString(string);
+	sprintf(string, " DAS=%lu", filterWork);
+	UART_OutString(string);
+	sprintf(string, " jitter=%ld", jitter);
+	UART_OutString(string);
+	UART_NewLine();
+	sprintf(string, "60Hz=%lu", mains60);
+	UART_OutString(string);
+	sprintf(string, " 180Hz=%lu", mains180);
+	UART_OutString(string);
+	sprintf(string, " hum=%u", Hum.Amplitude[0]);
+	UART_OutString(string);
+}
+
+// ******** Jitter ************
+// print the nonzero bins of the DAS jitter histogram, 0.1us per bin,
+// the last bin also counts everything larger
+// the copy is static, it does not fit on a thread stack
+#define JITTERCOPYSIZE 64
+static unsigned long JitterCopy[JITTERCOPYSIZE];
+void Jitter(void) {
+	char string[20];
+	uint32_t size = JitterSize;
+	if(size > JITTERCOPYSIZE) {
+		size = JITTERCOPYSIZE;
+	}
+	Seq_Snapshot(&DASSeq, JitterCopy, JitterHistogram, size*sizeof(unsigned long));
+	UART_OutString("0.1us count");
+	for(uint32_t i = 0; i < size; i++) {
+		if(JitterCopy[i]) {
 			UART_NewLine();
+			sprintf(string, "%4u %lu", i, JitterCopy[i]);
+			UART_OutString(string);
 		}
-	}*/
+	}
+}
+
+// ******** Signal ************
+// print the live statistics of the DAS and Producer inputs,
+// in ADC counts with one decimal, nothing is buffered
+void print_signal_line(char* string, char* name, StatsType *s) {
+	StatsSnapshotType snap;
+	Stats_Snapshot(s, &snap);
+	UART_OutString(name);
+	sprintf(string, " n=%u", snap.Count);
+	UART_OutString(string);
+	sprintf(string, " mean=%ld.%ld", (long)snap.Mean/256, (long)(snap.Mean%256)*10/256);
+	UART_OutString(string);
+	sprintf(string, " sd=%ld.%ld", (long)snap.StdDev/256, (long)(snap.StdDev%256)*10/256);
+	UART_OutString(string);
+	sprintf(string, " rms=%ld.%ld", (long)snap.Rms/256, (long)(snap.Rms%256)*10/256);
+	UART_OutString(string);
+	sprintf(string, " min=%ld", (long)snap.Min);
+	UART_OutString(string);
+	sprintf(string, " max=%ld", (long)snap.Max);
+	UART_OutString(string);
+}
+void print_signal(char* string) {
+	print_signal_line(string, "DAS PD3 100ms:", &DASStats);
+	UART_NewLine();
+	print_signal_line(string, "Producer PD2 160ms:", &ProducerStats);
+}
+
+// ******** Math ************
+// time each FixMath function on spread out inputs, best of MATHRUNS
+// loops of MATHCALLS calls so an interrupt in one loop does not count,
+// less the empty loop, OS_Time counts 12.5ns so a count is a cycle
+#define MATHCALLS 32
+#define MATHRUNS  8
+static volatile int32_t MathSink;
+#define MATH_BEST(best, call) do{ \
+	unsigned long start, time; \
+	uint32_t i, run; \
+	best = 0xFFFFFFFF; \
+	for(run = 0; run < MATHRUNS; run++) { \
+		start = OS_Time(); \
+		for(i = 1; i <= MATHCALLS; i++) { \
+			MathSink = call; \
+		} \
+		time = OS_TimeDifference(start, OS_Time()); \
+		if(time < best) best = time; \
+	} \
+}while(0)
+void print_math_line(char* string, char* name, unsigned long time, unsigned long empty) {
+	UART_NewLine();
+	UART_OutString(name);
+	sprintf(string, " %lu", (time > empty) ? (time - empty)/MATHCALLS : 0);
+	UART_OutString(string);
+}
+void print_math(char* string) {
+	unsigned long empty, time;
+	MATH_BEST(empty, (int32_t)i);
+	UART_OutString("cycles per call");
+	MATH_BEST(time, FixMath_Sin(i*0x9E3779B9));
+	print_math_line(string, "sin", time, empty);
+	MATH_BEST(time, FixMath_Cos(i*0x9E3779B9));
+	print_math_line(string, "cos", time, empty);
+	MATH_BEST(time, (int32_t)FixMath_Sqrt(i*0x9E3779B9));
+	print_math_line(string, "sqrt", time, empty);
+	MATH_BEST(time, (int32_t)FixMath_Sqrt64((uint64_t)i*0x9E3779B97F4A7C15ULL));
+	print_math_line(string, "sqrt64", time, empty);
+	MATH_BEST(time, FixMath_Log2(i*0x9E3779B9));
+	print_math_line(string, "log2", time, empty);
+	MATH_BEST(time, FixMath_Db(i*0x9E37));
+	print_math_line(string, "db", time, empty);
+	MATH_BEST(time, FixMath_Atan2((int32_t)(i*0x9E3779B9), (int32_t)(i*0x7F4A7C15)));
+	print_math_line(string, "atan2", time, empty);
 }
 
 void Interpreter(void) {
@@ -170,6 +392,24 @@ void Interpreter(void) {
 			case(7):
 				UART_OutString("YOU DONE F'D UP");
 				break;
+			case(8):
+				print_mem(string);
+				break;
+			case(9):
+				print_load(string);
+				break;
+			case(10):
+				print_stats(string);
+				break;
+			case(11):
+				Jitter();
+				break;
+			case(12):
+				print_signal(string);
+				break;
+			case(13):
+				print_math(string);
+				break;
 		}
 	}
 }
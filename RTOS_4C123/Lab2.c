@@ -27,33 +27,67 @@
 #include "inc/tm4c123gh6pm.h"
 #include "ST7735.h"
 #include "ADCT0ATrigger.h"
+#include "Seqlock.h"
+#include "CIC.h"
+#include "Biquad.h"
+#include "FIR.h"
+#include "FFT.h"
+#include "Tone.h"
+#include "PID.h"
+#include "Stats.h"
+#include "Scope.h"
 //#include "UART2.h"
 #include "Interpreter.h"
 #include <string.h> 
 #include <assert.h>
 
-//*********Prototype for FFT in cr4_fft_64_stm32.s, STMicroelectronics
-void cr4_fft_64_stm32(void *pssOUT, void *pssIN, unsigned short Nbin);
 //*********Prototype for PID in PID_stm32.s, STMicroelectronics
 short PID_stm32(short Error, short *Coeff);
 
 unsigned long NumCreated;   // number of foreground threads created
 unsigned long PIDWork;      // current number of PID calculations finished
+RWLockType PIDLock;         // PID thread writes PIDWork and Actuator, display and interpreter read
 unsigned long FilterWork;   // number of digital filter calculations finished
 unsigned long NumSamples;   // incremented every ADC sample, in Producer
 #define FS 400            // producer/consumer sampling
 #define RUNLENGTH (20*FS) // display results and quit when NumSamples==RUNLENGTH
 // 20-sec finite time experiment duration 
 
-#define PERIOD TIME_500US // DAS 2kHz sampling period in system time units
-long x[64],y[64];         // input and output arrays for FFT
+// PERIOD, the DAS 2kHz sampling period, is in OSConfig.h with the DAS task
+#define FFTSIZE 128       // Consumer spectrum, real input on the 64 point kernel
+#define FFTHOP  64        // 50% overlap, a spectrum every 64 samples
+int32_t x[FFTSIZE/2],y[FFTSIZE/2];  // input and output arrays for FFT
+int16_t FFTWindow[FFTSIZE], FFTFrame[FFTSIZE];
+int16_t FFTTwiddle[FFTSIZE/4+1];
+FFTType ConsumerFFT;
+uint16_t Spectrum[FFTSIZE/2];   // magnitude of the latest spectrum
+unsigned long PeakBin;          // largest bin other than DC, FS/FFTSIZE Hz each
 
 //---------------------User debugging-----------------------
 unsigned long DataLost;     // data sent by Producer, but not received by Consumer
-long MaxJitter;             // largest time jitter between interrupts in usec
+long MaxJitter;             // largest sampling jitter of DAS in 0.1 usec
+// DAS jitter is how late each sample is behind its hardware timer
+// event, beyond the best case, OS_PeriodicTime gives the event time
 #define JITTERSIZE 64
 unsigned long const JitterSize=JITTERSIZE;
 unsigned long JitterHistogram[JITTERSIZE]={0,};
+SeqLockType DASSeq;         // DAS writes FilterWork, MaxJitter, JitterHistogram and Mains under it
+// mains pickup on the DAS input, 60 Hz and its 3rd harmonic,
+// sliding DFT over the last 100 samples (50 ms), 20 Hz bins
+#define MAINSWINDOW 100
+const uint32_t MainsFreq[2] = {60, 180};
+static int16_t MainsDelay[MAINSWINDOW];
+SlidingDFTType MainsDFT;
+unsigned long Mains[2];     // amplitude in ADC counts, updated every DAS sample
+// 60 Hz on the Producer input, Goertzel over 40 samples (100 ms)
+#define HUMBLOCK 40
+const uint32_t HumFreq[1] = {60};
+GoertzelType Hum;
+// live statistics of both inputs for the interpreter's sig command
+#define DASSTATSWINDOW 200  // last 100 ms of DAS samples
+static int16_t DASHistory[DASSTATSWINDOW];
+StatsType DASStats;         // PD3, windowed
+StatsType ProducerStats;    // PD2, exponentially weighted, 64 samples
 #define PE0  (*((volatile unsigned long *)0x40024004))
 #define PE1  (*((volatile unsigned long *)0x40024008))
 #define PE2  (*((volatile unsigned long *)0x40024010))
@@ -73,54 +107,56 @@ void PortE_Init(void){ unsigned long volatile delay;
 // 2 kHz sampling ADC channel 1, using software start trigger
 // background thread executed at 2 kHz
 // 60-Hz notch high-Q, IIR filter, assuming fs=2000 Hz
-// y(n) = (256x(n) -503x(n-1) + 256x(n-2) + 498y(n-1)-251y(n-2))/256 (2k sampling)
-// y(n) = (256x(n) -476x(n-1) + 256x(n-2) + 471y(n-1)-251y(n-2))/256 (1k sampling)
-long Filter(long data){
-static long x[6]; // this MACQ needs twice
-static long y[6];
-static unsigned long n=3;   // 3, 4, or 5
-  n++;
-  if(n==6) n=3;     
-  x[n] = x[n-3] = data;  // two copies of new data
-  y[n] = (256*(x[n]+x[n-2])-503*x[n-1]+498*y[n-1]-251*y[n-2]+128)/256;
-  y[n-3] = y[n];         // two copies of filter outputs too
-  return y[n];
+// Notch60, 1 section at fs = 2000 Hz, from tools/BiquadDesign
+#define Notch60_STAGES 1
+const int32_t Notch60[BIQUAD_Q15_COEFFS*Notch60_STAGES] = {
+  16224, 0x3F60837F, 0xC1407C81,  // notch 60 Hz Q 9.5
+};
+static int32_t NotchState[BIQUAD_Q15_STATE(Notch60_STAGES)];
+BiquadQ15Type Notch = {Notch60_STAGES, Notch60, NotchState};
+// 12-bit samples are scaled up by 8 to use the Q15 range
+RAMFUNC long Filter(long data){
+  return Biquad_Q15Step(&Notch, data<<3)>>3;
 }
 //******** DAS *************** 
 // background thread, calculates 60Hz notch filter
+// and measures the 60 and 180 Hz pickup the notch removes
 // runs 2000 times/sec
 // samples channel 4, PD3,
 // inputs:  none
 // outputs: none
 unsigned long DASoutput;
-void DAS(void){ 
+RAMFUNC void DAS(void){ 
 	unsigned long input;  
-	unsigned static long LastTime;  // time at previous ADC sample
-	unsigned long thisTime;         // time at current ADC sample
-	long jitter;                    // time between measured and expected, in us
+	unsigned long sampleTime;       // time at current ADC sample
+	unsigned long latency;          // from the timer event to the sample, 12.5 ns
+	static unsigned long MinLatency = 0xFFFFFFFF;  // best case, ISR entry and OS overhead
+	long jitter;                    // lateness beyond the best case, in 0.1 us
   if(NumSamples < RUNLENGTH){   // finite time run
     PE0 ^= 0x01;
+    sampleTime = OS_Time();     // when the conversion starts
     input = ADC_In();           // channel set when calling ADC_Init
     PE0 ^= 0x01;
-    thisTime = OS_Time();       // current time, 12.5 ns
+    latency = OS_TimeDifference(OS_PeriodicTime(), sampleTime);
     DASoutput = Filter(input);
+    SlidingDFT_Step(&MainsDFT, (long)input-2048);
+    Stats_Step(&DASStats, input);
+    Seq_WriteBegin(&DASSeq);
     FilterWork++;        // calculation finished
-    if(FilterWork>1){    // ignore timing of first interrupt
-      unsigned long diff = OS_TimeDifference(LastTime,thisTime);
-      if(diff>PERIOD){
-        jitter = (diff-PERIOD+4)/8;  // in 0.1 usec
-      }else{
-        jitter = (PERIOD-diff+4)/8;  // in 0.1 usec
-      }
-      if(jitter > MaxJitter){
-        MaxJitter = jitter; // in usec
-      }       // jitter should be 0
-      if(jitter >= JitterSize){
-        jitter = JITTERSIZE-1;
-      }
-      JitterHistogram[jitter]++; 
+    Mains[0] = SlidingDFT_Amplitude(&MainsDFT, 0);
+    Mains[1] = SlidingDFT_Amplitude(&MainsDFT, 1);
+    if(latency < MinLatency){
+      MinLatency = latency;
+    }
+    jitter = (latency-MinLatency+4)/8;  // in 0.1 usec
+    if(jitter > MaxJitter){
+      MaxJitter = jitter;
+    }       // jitter should be 0
+    if(jitter >= JitterSize){
+      jitter = JITTERSIZE-1;
     }
-    LastTime = thisTime;
+    JitterHistogram[jitter]++; 
+    Seq_WriteEnd(&DASSeq);
     PE0 ^= 0x01;
   }
 }
@@ -132,14 +168,25 @@ void DAS(void){
 // foreground treads run for 2 sec and die
 // ***********ButtonWork*************
 void ButtonWork(void){
+unsigned long work;
+long jitter;
+uint32_t seq;
 //unsigned long myId = OS_Id(); 
   PE1 ^= 0x02;
   ST7735_Message(1,0,"NumCreated =",NumCreated); 
   PE1 ^= 0x02;
   OS_Sleep(50);     // set this to sleep for 50msec
-  ST7735_Message(1,1,"PIDWork     =",PIDWork);
+  OS_ReadLock(&PIDLock);
+  work = PIDWork;
+  OS_ReadUnlock(&PIDLock);
+  ST7735_Message(1,1,"PIDWork     =",work);
   ST7735_Message(1,2,"DataLost    =",DataLost);
-  ST7735_Message(1,3,"Jitter 0.1us=",MaxJitter);
+  do{
+    seq = Seq_ReadBegin(&DASSeq);
+    jitter = MaxJitter;
+  }while(Seq_ReadRetry(&DASSeq, seq));
+  ST7735_Message(1,3,"Jitter 0.1us=",jitter);
+  ST7735_Message(1,4,"CPU 0.1%    =",OS_CPULoad(1));
   PE1 ^= 0x02;
   OS_Kill();  // done, OS does not return from a Kill
   assert(false);
@@ -175,7 +222,7 @@ void SW2Push(void){
 // hardware timer-triggered ADC sampling at 400Hz
 // Producer runs as part of ADC ISR
 // Producer uses fifo to transmit 400 samples/sec to Consumer
-// every 64 samples, Consumer calculates FFT
+// every 64 samples, Consumer calculates a 128 point real FFT, 50% overlap
 // every 2.5ms*64 = 160 ms (6.25 Hz), consumer sends data to Display via mailbox
 // Display thread updates LCD with measurement
 
@@ -186,11 +233,15 @@ void SW2Push(void){
 // Your ADC ISR runs when ADC data is ready
 // Your ADC ISR calls this function with a 12-bit sample 
 // sends data to the consumer, runs periodically at 400Hz
+// and tracks the 60 Hz hum, Hum.Amplitude[0] in ADC counts,
+// and the signal statistics
 // inputs:  none
 // outputs: none
 void Producer(uint32_t data){  
   if(NumSamples < RUNLENGTH){   // finite time run
     NumSamples++;               // number of samples
+    Goertzel_Step(&Hum, (int32_t)data-2048);
+    Stats_Step(&ProducerStats, data);
     if(OS_Fifo_Put(data) == 0){ // send to consumer
       DataLost++;
     } 
@@ -200,28 +251,37 @@ void Display(void);
 
 //******** Consumer *************** 
 // foreground thread, accepts data from producer
-// calculates FFT, sends DC component to Display
+// calculates a Hann windowed magnitude spectrum,
+// sends DC component to Display
 // inputs:  none
 // outputs: none
 void Consumer(void){ 
 unsigned long data,DCcomponent;   // 12-bit raw ADC sample, 0 to 4095
 unsigned long t;                  // time in 2.5 ms
+unsigned long sum;
+static int16_t samples[FFTHOP];  // off the thread stack
 //unsigned long myId = OS_Id(); 
 
+  FFT_InitReal(&ConsumerFFT, FFTSIZE, FFT_HANN, FFTHOP, FFTWindow, FFTFrame, x, y, FFTTwiddle);
   ADC_Init(5, FS, &Producer); // start ADC sampling, channel 5, PD2, 400 Hz
   NumCreated += OS_AddThread(&Display, 0); 
   while(NumSamples < RUNLENGTH) { 
     PE2 = 0x04;
-    for(t = 0; t < 64; t++){   // collect 64 ADC samples
-			if (t==63){
-			    t=63;
-			}
+    sum = 0;
+    for(t = 0; t < FFTHOP; t++){   // collect 64 new ADC samples
       data = OS_Fifo_Get();    // get from producer
-      x[t] = data;             // real part is 0 to 4095, imaginary part is 0
+      sum += data;
+      samples[t] = (int16_t)((data<<4) - 32768);  // 0 to 4095 to Q15
     }
     PE2 = 0x00;
-    cr4_fft_64_stm32(y,x,64);  // complex FFT of last 64 ADC values
-    DCcomponent = y[0]&0xFFFF; // Real part at frequency 0, imaginary part should be zero
+    FFT_Spectrum(&ConsumerFFT, samples, Spectrum);  // last 128 ADC values
+    PeakBin = 1;
+    for(t = 2; t < FFTSIZE/2; t++){
+      if(Spectrum[t] > Spectrum[PeakBin]){
+        PeakBin = t;
+      }
+    }
+    DCcomponent = sum/FFTHOP;  // average of the new samples
     OS_MailBox_Send(DCcomponent); // called every 2.5ms*64 = 160ms
   }
   OS_Kill();  // done
@@ -249,28 +309,40 @@ unsigned long data,voltage;
 // foreground thread that runs without waiting or sleeping
 // it executes a digital controller 
 //******** PID *************** 
-// foreground thread, runs a PID controller
+// foreground thread, runs a bank of PID controllers
 // never blocks, never sleeps, never dies
 // inputs:  none
 // outputs: none
+// IntTerm and PrevError are the state of PID_stm32 in PID_stm32.s,
+// which imports them by name
 short IntTerm;     // accumulated error, RPM-sec
 short PrevError;   // previous error, RPM
-short Coeff[3];    // PID coefficients
+short Coeff[3];    // PID_stm32 coefficients
 short Actuator;
+#define NUMLOOPS 4 // motor speed loops, one PID_StepN call runs them all
+PIDType Loops[NUMLOOPS];
+int32_t LoopError[NUMLOOPS], LoopOut[NUMLOOPS];
 void PID(void){ 
-short err;  // speed error, range -100 to 100 RPM
+long err;  // speed error, range -1000 to 1000 RPM
+uint32_t i;
 //unsigned long myId = OS_Id(); 
+  OS_WriteLock(&PIDLock);
   PIDWork = 0;
-  IntTerm = 0;
-  PrevError = 0;
-  Coeff[0] = 384;   // 1.5 = 384/256 proportional coefficient
-  Coeff[1] = 128;   // 0.5 = 128/256 integral coefficient
-  Coeff[2] = 64;    // 0.25 = 64/256 derivative coefficient*
+  OS_WriteUnlock(&PIDLock);
+  for(i = 0; i < NUMLOOPS; i++){  // Kp 1.5, Ki 0.5, Kd 0.25, command +/-1000
+    PID_Init(&Loops[i], PID_GAIN(1.5), PID_GAIN(0.5), PID_GAIN(0.25), 8192, -1000, 1000);
+  }
   while(NumSamples < RUNLENGTH) { 
     for(err = -1000; err <= 1000; err++){    // made-up data
-      Actuator = PID_stm32(err,Coeff)/256;
+      for(i = 0; i < NUMLOOPS; i++){
+        LoopError[i] = err>>i;
+      }
+      PID_StepN(Loops, LoopError, LoopOut, NUMLOOPS);
     }
+    OS_WriteLock(&PIDLock);
+    Actuator = LoopOut[0];
     PIDWork++;        // calculation finished
+    OS_WriteUnlock(&PIDLock);
   }
   for(;;){ }          // done
 }
@@ -305,7 +377,13 @@ int main(void){ //main0
   PortE_Init();
   DataLost = 0;        // lost data between producer and consumer
   NumSamples = 0;
-  MaxJitter = 0;       // in 1us units
+  MaxJitter = 0;       // in 0.1us units
+  Seq_Init(&DASSeq);
+  OS_InitRWLock(&PIDLock);
+  SlidingDFT_Init(&MainsDFT, 2000, MainsFreq, 2, MAINSWINDOW, MainsDelay);
+  Goertzel_Init(&Hum, FS, HumFreq, 1, HUMBLOCK);
+  Stats_InitWindow(&DASStats, DASHistory, DASSTATSWINDOW);
+  Stats_InitDecay(&ProducerStats, 6);
 
 //********initialize communication channels
   OS_MailBox_Init();
@@ -315,6 +393,11 @@ int main(void){ //main0
   OS_AddSW1Task(&SW1Push,2);
 //  sk(&SW2Push,2);  // add this line in Lab 3
   ADC_Init(4, FS, &Producer);  // sequencer 3, channel 4, PD3, sampling in DAS()
+#if OS_STATIC_CONFIG
+// DAS at 2 kHz and the initial foreground threads Interpreter,
+// Consumer and PID are built in by OSConfig.h, DAS starts in OS_Launch
+  NumCreated = OS_NUM_STATIC_THREADS;
+#else
   OS_AddPeriodicThread(&DAS,PERIOD,1); // 2 kHz real time sampling of PD3
 
   NumCreated = 0 ;
@@ -322,6 +405,7 @@ int main(void){ //main0
   NumCreated += OS_AddThread(&Interpreter, 2); 
   NumCreated += OS_AddThread(&Consumer, 1); 
   NumCreated += OS_AddThread(&PID, 3);  // Lab 3, make this lowest priority
+#endif
  
   OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
   return 0;            // this never executes
@@ -762,3 +846,525 @@ int main7(void){       // main7
   return 0;             // this never executes
 }*/
 
+//******************* Measurement of cooperative switch time**********
+// Two threads ping-pong with OS_Suspend, nothing else runs
+// main8 uses the cooperative OS_Yield path (function call, R3-R11,LR)
+// main9 runs the same threads preemptively, so each OS_Suspend
+//       pends SysTick and switches through OS_ISR
+// SwitchTime is the average cost of one OS_Suspend, in 12.5ns bus cycles
+// logic analyzer on PE0 and PE1 shows the same thing
+// UART0 used to print the result
+#define YIELDRUNS 10000
+unsigned long YieldCount;     // number of OS_Suspend calls so far
+unsigned long YieldStart;     // OS_Time at first OS_Suspend
+unsigned long SwitchTime;     // average time per switch, 12.5ns units
+void YieldThreadA(void){
+  YieldCount = 0;
+  YieldStart = OS_Time();
+  for(;;){
+    PE0 ^= 0x01;
+    YieldCount++;
+    if(YieldCount == YIELDRUNS){
+      SwitchTime = OS_TimeDifference(YieldStart,OS_Time())/YIELDRUNS;
+      UART_OutString("\n\rCycles per switch = ");
+      UART_OutUDec(SwitchTime);
+      UART_OutString("\n\r");
+    }
+    OS_Suspend();
+  }
+}
+void YieldThreadB(void){
+  for(;;){
+    PE1 ^= 0x02;
+    YieldCount++;
+    OS_Suspend();
+  }
+}
+int main8(void){       // main8, cooperative
+  OS_Init(false);          // initialize, disable interrupts, cooperative
+  PortE_Init();
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&YieldThreadA, 1); 
+  NumCreated += OS_AddThread(&YieldThreadB, 1); 
+  OS_Launch(TIME_2MS);     // time slice not used, doesn't return
+  return 0;                // this never executes
+}
+int main9(void){       // main9, same threads through SysTick
+  OS_Init(true);           // initialize, disable interrupts, preemptive
+  PortE_Init();
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&YieldThreadA, 1); 
+  NumCreated += OS_AddThread(&YieldThreadB, 1); 
+  OS_Launch(TIME_2MS);     // doesn't return, interrupts enabled in here
+  return 0;                // this never executes
+}
+
+//******************* Measurement of system call overhead**********
+// Compares a direct kernel call with the same call through SVC
+// main runs privileged, so OS_bSignal takes the direct path there,
+// SVC_bSignal is what every unprivileged thread pays instead
+// the DWT cycle counter is privileged, so this runs before OS_Launch
+// UART0 used to print the result, in bus cycles per call
+#define DWT_CTRL_R    (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R  (*((volatile uint32_t *)0xE0001004))
+#define DEMCR_R       (*((volatile uint32_t *)0xE000EDFC))
+#define CALLRUNS 1000
+Sema4Type SVCSema4;
+uint32_t DirectCycles;  // cycles per direct OS_bSignal
+uint32_t SVCCycles;     // cycles per OS_bSignal through SVC
+int main10(void){      // main10
+  uint32_t start, i;
+  OS_Init(true);           // initialize, disable interrupts
+  OS_InitSemaphore(&SVCSema4, 0);
+  DEMCR_R |= 0x01000000;   // TRCENA, enable DWT
+  DWT_CYCCNT_R = 0;
+  DWT_CTRL_R |= 0x01;      // CYCCNTENA
+  OS_EnableInterrupts();   // SVC with interrupts masked is a HardFault
+  start = DWT_CYCCNT_R;
+  for(i = 0; i < CALLRUNS; i++){
+    OS_bSignal(&SVCSema4);
+  }
+  DirectCycles = (DWT_CYCCNT_R-start)/CALLRUNS;
+  start = DWT_CYCCNT_R;
+  for(i = 0; i < CALLRUNS; i++){
+    SVC_bSignal(&SVCSema4);
+  }
+  SVCCycles = (DWT_CYCCNT_R-start)/CALLRUNS;
+  UART_OutString("\n\rDirect cycles per call = ");
+  UART_OutUDec(DirectCycles);
+  UART_OutString("\n\rSVC cycles per call    = ");
+  UART_OutUDec(SVCCycles);
+  UART_OutString("\n\r");
+  OS_DisableInterrupts();
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&Thread3b, 1); 
+  OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
+  return 0;            // this never executes
+}
+
+//******************* uDMA streaming at 100 kHz**********
+// ADC0 SS3 samples PD3 at 100 kHz into 128 sample blocks by uDMA,
+// one ADC interrupt per block instead of one per sample
+// each full block goes to FrameConsumer through the frame channel,
+// the ISR swaps in a fresh MemPool block so nothing is copied
+#define FRAMESIZE 128          // samples per block, one 256 byte MemPool block
+#define FRAMEFS   100000       // sampling rate in Hz
+unsigned long FrameCount;      // blocks processed by FrameConsumer
+unsigned long FramesLost;      // blocks overwritten, pool or channel was full
+unsigned long FrameMean;       // average of the last block
+uint16_t *FrameBlock(uint16_t *full){  // runs in the ADC ISR
+  uint16_t *next = MemPool_Alloc(FRAMESIZE*sizeof(uint16_t));
+  if(next == 0){
+    FramesLost++;
+    return full;               // consumer is behind, refill the same block
+  }
+  if(OS_Frame_Put(full) == 0){
+    FramesLost++;
+    MemPool_Free(next);
+    return full;
+  }
+  return next;
+}
+void FrameConsumer(void){
+  uint16_t *frame;
+  unsigned long sum;
+  int i;
+  for(;;){
+    frame = OS_Frame_Get();
+    sum = 0;
+    for(i = 0; i < FRAMESIZE; i++){
+      sum += frame[i];
+    }
+    FrameMean = sum/FRAMESIZE;
+    FrameCount++;
+    MemPool_Free(frame);       // ownership came with the frame
+  }
+}
+int main11(void){      // main11
+  OS_Init(true);           // initialize, disable interrupts
+  PortE_Init();
+  FrameCount = 0;
+  FramesLost = 0;
+  ADC_InitDMA(4, FRAMEFS, MemPool_Alloc(FRAMESIZE*sizeof(uint16_t)),
+              MemPool_Alloc(FRAMESIZE*sizeof(uint16_t)), FRAMESIZE, &FrameBlock);
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&FrameConsumer, 1); 
+  NumCreated += OS_AddThread(&Interpreter, 2);   // "load" shows the CPU cost
+  OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
+  return 0;            // this never executes
+}
+
+//******************* Coherent scan of PD3, PD2 and temperature**********
+// one Timer0A trigger samples Ain4 (PD3), Ain5 (PD2) and the internal
+// temperature sensor with ADC0 SS0, one interrupt per scan
+// each block of SCANLENGTH scans is averaged by ScanDisplay
+#define SCANLENGTH 100         // scans per block, 0.1 s at 1 kHz
+#define SCANCHANNELS 3
+const uint8_t ScanList[SCANCHANNELS] = {4, 5, ADC_TEMPSENSOR};
+uint16_t ScanPD3[SCANLENGTH];
+uint16_t ScanPD2[SCANLENGTH];
+uint16_t ScanTemp[SCANLENGTH];
+uint16_t * const ScanBuffers[SCANCHANNELS] = {ScanPD3, ScanPD2, ScanTemp};
+Sema4Type ScanReady;           // signaled each time the buffers fill
+// the ISR starts refilling the buffers on the next scan, so ScanDone
+// copies the full block under ScanSeq and ScanDisplay snapshots that
+uint16_t ScanCopy[SCANCHANNELS][SCANLENGTH];  // last full block
+uint16_t ScanView[SCANCHANNELS][SCANLENGTH];  // ScanDisplay's copy
+SeqLockType ScanSeq;
+void ScanDone(uint32_t length){  // runs in the ADC ISR
+  int i;
+  Seq_WriteBegin(&ScanSeq);
+  for(i = 0; i < SCANCHANNELS; i++){
+    memcpy(ScanCopy[i], ScanBuffers[i], sizeof(ScanCopy[i]));
+  }
+  Seq_WriteEnd(&ScanSeq);
+  OS_Signal(&ScanReady);
+}
+unsigned long ScanAverage(uint16_t *buf){
+  unsigned long sum = 0;
+  int i;
+  for(i = 0; i < SCANLENGTH; i++){
+    sum += buf[i];
+  }
+  return sum/SCANLENGTH;
+}
+void ScanDisplay(void){
+  unsigned long temp;
+  for(;;){
+    OS_Wait(&ScanReady);
+    Seq_Snapshot(&ScanSeq, ScanView, ScanCopy, sizeof(ScanView));
+    ST7735_Message(0,0,"PD3         =",ScanAverage(ScanView[0]));
+    ST7735_Message(0,1,"PD2         =",ScanAverage(ScanView[1]));
+    temp = 1475 - (2475*ScanAverage(ScanView[2]))/4096;
+    ST7735_Message(0,2,"Temp 0.1C   =",temp);
+  }
+}
+int main12(void){      // main12
+  OS_Init(true);           // initialize, disable interrupts
+  OS_InitSemaphore(&ScanReady, 0);
+  Seq_Init(&ScanSeq);
+  ADC_InitScan(ScanList, SCANCHANNELS, 1000, ScanBuffers, SCANLENGTH, &ScanDone);
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&ScanDisplay, 1); 
+  NumCreated += OS_AddThread(&Interpreter, 2); 
+  OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
+  return 0;            // this never executes
+}
+
+//******************* Oversampling and decimation**********
+// PD3 is converted 16 times per trigger and averaged in hardware,
+// the uDMA collects 32 kHz blocks, and a third order CIC in the
+// block callback decimates by 8 to 4 kHz
+// the CIC gain is 8^3 = 512, shifting by 6 instead of 9 keeps three
+// extra bits, so DecimatedBuf holds 15-bit samples
+#define DECIMATEFS     32000   // trigger rate, 16x averaging uses 512 ksps
+#define DECIMATEBLOCK  128     // samples per uDMA block
+#define DECIMATESIZE   64      // 15-bit outputs per buffer, 16 ms
+uint16_t DecimatePing[DECIMATEBLOCK];
+uint16_t DecimatePong[DECIMATEBLOCK];
+CICType DecimateCIC;
+int32_t DecimatedBuf[DECIMATESIZE];
+uint32_t DecimatedCount;       // outputs in DecimatedBuf
+Sema4Type DecimatedReady;      // signaled when DecimatedBuf fills
+uint16_t *DecimateBlock(uint16_t *full){  // runs in the ADC ISR
+  int32_t out[DECIMATEBLOCK/8+1];
+  uint32_t i, n;
+  n = CIC_Block(&DecimateCIC, full, DECIMATEBLOCK, out);
+  for(i = 0; i < n; i++){
+    DecimatedBuf[DecimatedCount] = out[i];
+    DecimatedCount++;
+    if(DecimatedCount == DECIMATESIZE){
+      DecimatedCount = 0;
+      OS_Signal(&DecimatedReady);
+    }
+  }
+  return full;                 // refill the same block
+}
+void DecimateDisplay(void){
+  long sum;
+  int i;
+  for(;;){
+    OS_Wait(&DecimatedReady);
+    sum = 0;
+    for(i = 0; i < DECIMATESIZE; i++){
+      sum += DecimatedBuf[i];
+    }
+    ST7735_Message(0,0,"PD3 15-bit  =",sum/DECIMATESIZE);
+  }
+}
+int main13(void){      // main13
+  OS_Init(true);           // initialize, disable interrupts
+  OS_InitSemaphore(&DecimatedReady, 0);
+  DecimatedCount = 0;
+  CIC_Init(&DecimateCIC, 3, 8, 6);
+  ADC_SetAveraging(ADC_SAC_AVG_16X);
+  ADC_InitDMA(4, DECIMATEFS, DecimatePing, DecimatePong, DECIMATEBLOCK, &DecimateBlock);
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&DecimateDisplay, 1); 
+  NumCreated += OS_AddThread(&Interpreter, 2); 
+  OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
+  return 0;            // this never executes
+}
+
+//******************* Simultaneous voltage and current**********
+// ADC0 samples PD3 (voltage) and ADC1 samples PD2 (current) on the
+// same Timer0A trigger at 10 kHz, so each pair has no phase skew
+// PowerBlock sums v*i over each 100 pair block for the average power
+#define PAIRBLOCK 100          // pairs per block, 10 ms
+uint32_t PairPing[PAIRBLOCK];
+uint32_t PairPong[PAIRBLOCK];
+unsigned long PowerSum;        // sum of v*i over the last block, raw ADC units
+unsigned long PowerTime;       // OS_Time of the first pair of that block
+Sema4Type PowerReady;
+void PowerBlock(uint32_t *pairs, uint32_t count, unsigned long time){  // ADC ISR
+  unsigned long sum = 0;
+  uint32_t i;
+  for(i = 0; i < count; i++){
+    sum += ADC_PAIR_A(pairs[i])*ADC_PAIR_B(pairs[i]);
+  }
+  PowerSum = sum;
+  PowerTime = time;
+  OS_Signal(&PowerReady);
+}
+void PowerDisplay(void){
+  for(;;){
+    OS_Wait(&PowerReady);
+    ST7735_Message(0,0,"v*i avg     =",PowerSum/PAIRBLOCK);
+    ST7735_Message(0,1,"at ms       =",PowerTime/80000);
+  }
+}
+int main14(void){      // main14
+  OS_Init(true);           // initialize, disable interrupts
+  OS_InitSemaphore(&PowerReady, 0);
+  ADC_InitDual(4, 5, 10000, PairPing, PairPong, PAIRBLOCK, &PowerBlock);
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&PowerDisplay, 1); 
+  NumCreated += OS_AddThread(&Interpreter, 2); 
+  OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
+  return 0;            // this never executes
+}
+
+//******************* Threshold alarms without software checks**********
+// the ADC comparators watch PD3 and PD2 on every Timer0A trigger,
+// the CPU only sees a half second uDMA block until a band is entered
+// comparator 0: PD3 at or above 2500, rearms below 1500, hysteresis
+// comparator 1: PD2 below 500, once, rearmed by the Interpreter-free
+//               AlarmWatch thread a second after it reports it
+#define ALARMFS    2000        // comparator rate, Hz
+#define ALARMBLOCK 1000        // samples per uDMA block
+uint16_t AlarmPing[ALARMBLOCK];
+uint16_t AlarmPong[ALARMBLOCK];
+int HighAlarm, LowAlarm;       // comparator numbers
+unsigned long HighCount, LowCount;
+uint16_t *AlarmBlock(uint16_t *full){  // ADC ISR, twice a second
+  return full;                 // samples unused, reuse the block
+}
+void AlarmWatch(void){
+  uint32_t comps;
+  for(;;){
+    comps = OS_ADC_WaitAlarm();
+    if(comps&(1<<HighAlarm)){
+      HighCount++;
+      ST7735_Message(0,0,"PD3 high    =",HighCount);
+    }
+    if(comps&(1<<LowAlarm)){
+      LowCount++;
+      ST7735_Message(0,1,"PD2 low     =",LowCount);
+      OS_Sleep(1000);          // at most one low alarm a second
+      ADC_ArmComparator(LowAlarm);
+    }
+  }
+}
+int main15(void){      // main15
+  OS_Init(true);           // initialize, disable interrupts
+  HighCount = 0;
+  LowCount = 0;
+  HighAlarm = ADC_InitComparator(4, 1500, 2500, ADC_DC_HIGH|ADC_DC_HYST);
+  LowAlarm = ADC_InitComparator(5, 500, 500, ADC_DC_LOW|ADC_DC_ONESHOT);
+  ADC_InitDMA(4, ALARMFS, AlarmPing, AlarmPong, ALARMBLOCK, &AlarmBlock);
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&AlarmWatch, 1); 
+  NumCreated += OS_AddThread(&Interpreter, 2); 
+  OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
+  return 0;            // this never executes
+}
+
+//******************* FIR decimation of frames**********
+// ADC0 SS3 samples PD3 at 8 kHz into 128 sample frames by uDMA,
+// FIRConsumer low passes each frame with 64 taps and keeps every
+// 4th output, 2 kHz out, working in place in the MemPool block
+// FIRBench first prints the cycles per tap of FIR_Q15 for 32, 64
+// and 128 taps on UART0, OS_Time counts 80 MHz bus cycles, and
+// the best of several runs leaves out time spent in ISRs
+// Lowpass64, 64 tap lowpass, fc = 800 Hz at fs = 8000 Hz, from tools/FIRDesign
+#define Lowpass64_TAPS 64
+const int16_t Lowpass64[Lowpass64_TAPS] = {
+  21, 9, -10, -30, -44, -43, -20, 25,
+  79, 117, 114, 52, -62, -190, -274, -259,
+  -115, 133, 402, 573, 535, 237, -274, -839,
+  -1221, -1178, -547, 684, 2346, 4115, 5600, 6447,
+  6447, 5600, 4115, 2346, 684, -547, -1178, -1221,
+  -839, -274, 237, 535, 573, 402, 133, -115,
+  -259, -274, -190, -62, 52, 114, 117, 79,
+  25, -20, -43, -44, -30, -10, 9, 21
+};
+#define FIRFS     8000         // input rate, Hz
+#define FIRDECIMATE 4          // 2 kHz out
+static int32_t FIRCoeffs[Lowpass64_TAPS/2];
+static int16_t FIRState[2*Lowpass64_TAPS];
+FIRQ15Type FIRLowpass;
+unsigned long FIRMean;         // average of the last decimated frame
+void FIRBench(void){
+  static int32_t coeffs[64];
+  static int16_t state[256];
+  static int16_t taps[128];
+  static int16_t block[128];
+  FIRQ15Type f;
+  char string[40];
+  unsigned long start, cycles, best;
+  uint32_t n, i, run;
+  for(i = 0; i < 128; i++){
+    taps[i] = Lowpass64[i%Lowpass64_TAPS];
+  }
+  for(n = 32; n <= 128; n = 2*n){
+    best = 0xFFFFFFFF;
+    for(run = 0; run < 8; run++){
+      for(i = 0; i < 128; i++){
+        block[i] = (int16_t)((i*1237)&0x7FFF);
+      }
+      FIR_Q15Init(&f, taps, n, 1, coeffs, state);
+      start = OS_Time();
+      FIR_Q15(&f, block, block, 128);
+      cycles = OS_TimeDifference(start, OS_Time());
+      if(cycles < best){
+        best = cycles;
+      }
+    }
+    sprintf(string, "FIR %u taps: %lu.%02lu cycles/tap", n,
+            best/(128*n), (100*best/(128*n))%100);
+    UART_OutString(string);
+    UART_NewLine();
+  }
+  OS_Kill();
+}
+void FIRConsumer(void){
+  int16_t *frame;
+  unsigned long sum;
+  uint32_t i, count;
+  for(;;){
+    frame = (int16_t *)OS_Frame_Get();
+    for(i = 0; i < FRAMESIZE; i++){   // 12-bit ADC to Q15, 0 V is -32768
+      frame[i] = (int16_t)((((uint16_t *)frame)[i]<<4) - 32768);
+    }
+    count = FIR_Q15(&FIRLowpass, frame, frame, FRAMESIZE);
+    sum = 0;
+    for(i = 0; i < count; i++){
+      sum += (frame[i] + 32768)>>4;
+    }
+    FIRMean = sum/count;
+    MemPool_Free(frame);
+  }
+}
+void FIRDisplay(void){
+  for(;;){
+    ST7735_Message(0,0,"FIR mean    =",FIRMean);
+    ST7735_Message(0,1,"lost frames =",FramesLost);
+    OS_Sleep(500);
+  }
+}
+int main16(void){      // main16
+  OS_Init(true);           // initialize, disable interrupts
+  FIR_Q15Init(&FIRLowpass, Lowpass64, Lowpass64_TAPS, FIRDECIMATE, FIRCoeffs, FIRState);
+  ADC_InitDMA(4, FIRFS, MemPool_Alloc(FRAMESIZE*sizeof(uint16_t)),
+              MemPool_Alloc(FRAMESIZE*sizeof(uint16_t)), FRAMESIZE, &FrameBlock);
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&FIRBench, 0);
+  NumCreated += OS_AddThread(&FIRConsumer, 1); 
+  NumCreated += OS_AddThread(&FIRDisplay, 2); 
+  NumCreated += OS_AddThread(&Interpreter, 2); 
+  OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
+  return 0;            // this never executes
+}
+
+//******************* Triggered capture of PD3**********
+// ADC0 SS3 samples PD3 at 10 kHz into 128 sample blocks by uDMA,
+// ScopeBlock feeds every block to the scope, which freezes 256
+// samples before and 768 from a rising edge through mid scale
+// ScopeDisplay plots the record, sends it out UART0 in binary
+// and re-arms; SW1 forces a trigger on a quiet input
+#define SCOPEFS    10000       // sampling rate in Hz
+#define SCOPEBLOCK 128         // samples per uDMA block
+#define SCOPEPRE   256         // 25.6 ms before the trigger
+#define SCOPEPOST  768         // 76.8 ms from the trigger on
+uint16_t ScopePing[SCOPEBLOCK], ScopePong[SCOPEBLOCK];
+uint16_t ScopeRing[SCOPEPRE+SCOPEPOST];
+ScopeType Scope;
+Sema4Type ScopeReady;          // signaled when a record freezes
+unsigned long ScopeRecords;    // records captured
+void ScopeDone(void){          // runs in the ADC ISR
+  OS_Signal(&ScopeReady);
+}
+uint16_t *ScopeBlock(uint16_t *full){  // runs in the ADC ISR
+  Scope_Block(&Scope, full, SCOPEBLOCK);
+  return full;                 // refill the same block
+}
+void ScopeForce(void){         // SW1
+  Scope_Force(&Scope);
+}
+void ScopeDisplay(void){
+  for(;;){
+    OS_Wait(&ScopeReady);
+    ScopeRecords++;
+    Scope_Plot(&Scope, 0, 4095);
+    ST7735_Message(0,0,"records     =",ScopeRecords);
+    Scope_Send(&Scope);
+    OS_Sleep(500);             // hold the picture
+    Scope_Arm(&Scope);
+  }
+}
+int main17(void){      // main17
+  OS_Init(true);           // initialize, disable interrupts
+  OS_InitSemaphore(&ScopeReady, 0);
+  ScopeRecords = 0;
+  Scope_Init(&Scope, ScopeRing, SCOPEPRE+SCOPEPOST, SCOPEPRE, SCOPEPOST,
+             SCOPE_RISING, 1950, 2150, &ScopeDone);  // 2048 with hysteresis
+  Scope_Arm(&Scope);
+  ADC_InitDMA(4, SCOPEFS, ScopePing, ScopePong, SCOPEBLOCK, &ScopeBlock);
+  OS_AddSW1Task(&ScopeForce, 2);
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&ScopeDisplay, 1); 
+  OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
+  return 0;            // this never executes
+}
+
+//******************* Stack guard and fault dump test**********
+// GuardThread runs unprivileged like every preemptive thread, so the
+// first 5 s check the MPU background regions: it runs from flash,
+// its stack is in SRAM, and it toggles PE1 and reads Timer2 through
+// OS_MsTime.  Then it recurses until it runs into its stack guard,
+// and OS_FaultDump prints a MemManage, IPSR 4 with DACCVIOL or
+// MSTKE in CFSR, for thread 0 on UART0.  Any earlier fault means
+// a background region is missing.
+unsigned long GuardDepth;      // calls deep when the guard was hit
+unsigned long GuardRecurse(unsigned long n){
+  volatile unsigned long local[4];   // about 24 bytes per call
+  local[0] = n;
+  GuardDepth = n;
+  return GuardRecurse(n+1) + local[0];
+}
+void GuardThread(void){
+  unsigned long start = OS_MsTime();
+  while(OS_MsTime() - start < 5000){
+    PE1 ^= 0x02;
+    OS_Sleep(100);
+  }
+  GuardRecurse(0);             // does not return
+}
+int main18(void){      // main18
+  OS_Init(true);           // initialize, disable interrupts
+  PortE_Init();
+  NumCreated = 0 ;
+  NumCreated += OS_AddThread(&GuardThread, 1); 
+  OS_Launch(TIME_2MS); // doesn't return, interrupts enabled in here
+  return 0;            // this never executes
+}
@@ -0,0 +1,157 @@
+// MemPool.c
+// Runs on LM4F120/TM4C123
+// Fixed-block memory pools for kernel objects, messages and
+// frame buffers.  Each class keeps a singly linked free list
+// threaded through the first word of the free blocks.
+// EE445M Lab 2
+
+// The free lists are lock-free so ISRs can allocate without
+// disabling interrupts.  The head is updated with LDREX/STREX.
+// The Cortex-M4 clears its exclusive monitor on every exception
+// entry and return, so if an ISR runs between the LDREX and the
+// STREX the STREX fails and the pop or push simply retries.
+// That also rules out the ABA problem on this single-core part.
+
+#include <stdint.h>
+#include "MemPool.h"
+
+struct MemPool{
+  volatile uint32_t Head;  // address of first free block, 0 if empty
+  uint32_t Start;          // address of first block in the class
+  uint32_t End;            // address one past the last block
+  uint32_t BlockSize;      // bytes per block
+  uint32_t NumBlocks;      // blocks in the class
+  volatile uint32_t Used;
+  volatile uint32_t HighWater;
+  volatile uint32_t Allocs;
+  volatile uint32_t Failures;
+};
+typedef struct MemPool MemPoolType;
+
+static uint32_t Pool0[MEMPOOL_COUNT0][MEMPOOL_SIZE0/4];
+static uint32_t Pool1[MEMPOOL_COUNT1][MEMPOOL_SIZE1/4];
+static uint32_t Pool2[MEMPOOL_COUNT2][MEMPOOL_SIZE2/4];
+
+static MemPoolType Pools[MEMPOOL_NUMCLASSES];
+
+// atomic read-modify-write, returns the new value
+static uint32_t AtomicAdd(volatile uint32_t *pt, int32_t n){
+  uint32_t value;
+  do{
+    value = __ldrex(pt) + n;
+  }while(__strex(value, pt));
+  return value;
+}
+
+// raise *pt to value if it is smaller
+static void AtomicMax(volatile uint32_t *pt, uint32_t value){
+  do{
+    if(__ldrex(pt) >= value){
+      __clrex();
+      return;
+    }
+  }while(__strex(value, pt));
+}
+
+static void MemPool_InitClass(MemPoolType *pool, uint32_t *start,
+                              uint32_t blockSize, uint32_t numBlocks){
+  uint32_t i;
+  uint32_t addr = (uint32_t)start;
+  pool->Start = addr;
+  pool->End = addr + blockSize*numBlocks;
+  pool->BlockSize = blockSize;
+  pool->NumBlocks = numBlocks;
+  pool->Used = 0;
+  pool->HighWater = 0;
+  pool->Allocs = 0;
+  pool->Failures = 0;
+  for(i = 0; i < numBlocks-1; i++){  // each block points to the next
+    *(uint32_t *)(addr + i*blockSize) = addr + (i+1)*blockSize;
+  }
+  *(uint32_t *)(addr + i*blockSize) = 0;  // end of list
+  pool->Head = addr;
+}
+
+// ******** MemPool_Init ************
+// Link every block of every class onto its free list
+// and clear the statistics
+// Inputs:  none
+// Outputs: none
+void MemPool_Init(void){
+  MemPool_InitClass(&Pools[0], &Pool0[0][0], MEMPOOL_SIZE0, MEMPOOL_COUNT0);
+  MemPool_InitClass(&Pools[1], &Pool1[0][0], MEMPOOL_SIZE1, MEMPOOL_COUNT1);
+  MemPool_InitClass(&Pools[2], &Pool2[0][0], MEMPOOL_SIZE2, MEMPOOL_COUNT2);
+}
+
+// ******** MemPool_Alloc ************
+// Get one block from the smallest class that fits
+// Can be called from foreground threads and from ISRs
+// Inputs:  number of bytes needed
+// Outputs: pointer to the block, 0 if the class is empty
+//          or the request is larger than the largest class
+void *MemPool_Alloc(uint32_t size){
+  MemPoolType *pool;
+  uint32_t block, next;
+  if(size <= MEMPOOL_SIZE0){
+    pool = &Pools[0];
+  } else if(size <= MEMPOOL_SIZE1){
+    pool = &Pools[1];
+  } else if(size <= MEMPOOL_SIZE2){
+    pool = &Pools[2];
+  } else{
+    return 0;                     // too big for any class
+  }
+  do{
+    block = __ldrex(&pool->Head);
+    if(block == 0){
+      __clrex();
+      AtomicAdd(&pool->Failures, 1);
+      return 0;                   // class is empty
+    }
+    next = *(uint32_t *)block;
+  }while(__strex(next, &pool->Head));
+  AtomicMax(&pool->HighWater, AtomicAdd(&pool->Used, 1));
+  AtomicAdd(&pool->Allocs, 1);
+  return (void *)block;
+}
+
+// ******** MemPool_Free ************
+// Return a block obtained from MemPool_Alloc
+// Can be called from foreground threads and from ISRs
+// Inputs:  pointer to the block, 0 is ignored
+// Outputs: none
+void MemPool_Free(void *block){
+  MemPoolType *pool;
+  uint32_t addr = (uint32_t)block;
+  uint32_t i;
+  for(i = 0; i < MEMPOOL_NUMCLASSES; i++){  // fixed number of classes
+    pool = &Pools[i];
+    if((addr >= pool->Start) && (addr < pool->End)){
+      do{
+        *(uint32_t *)addr = __ldrex(&pool->Head);
+      }while(__strex(addr, &pool->Head));
+      AtomicAdd(&pool->Used, -1);
+      return;
+    }
+  }
+}
+
+// ******** MemPool_Stats ************
+// Copy the statistics of one pool class
+// Inputs:  class number 0 to MEMPOOL_NUMCLASSES-1
+//          pointer to the structure to fill
+// Outputs: 1 if successful, 0 if the class does not exist
+int MemPool_Stats(uint32_t poolClass, MemPoolStatsType *stats){
+  MemPoolType *pool;
+  if(poolClass >= MEMPOOL_NUMCLASSES){
+    return 0;
+  }
+  pool = &Pools[poolClass];
+  stats->BlockSize = pool->BlockSize;
+  stats->NumBlocks = pool->NumBlocks;
+  stats->Used = pool->Used;
+  stats->HighWater = pool->HighWater;
+  stats->Allocs = pool->Allocs;
+  stats->Failures = pool->Failures;
+  return 1;
+}
@@ -0,0 +1,63 @@
+// MemPool.h
+// Runs on LM4F120/TM4C123
+// Fixed-block memory pools for kernel objects, messages and
+// frame buffers.  Allocation and release are O(1) and never
+// fragment, unlike malloc.  Each block size is a separate pool
+// class, and the caller gets a block from the smallest class
+// that fits the request.
+// EE445M Lab 2
+
+#ifndef __MEMPOOL_H__ // do not include more than once
+#define __MEMPOOL_H__
+#include <stdint.h>
+
+// pool classes, block sizes must be a multiple of 4 bytes
+#define MEMPOOL_NUMCLASSES  3
+#define MEMPOOL_SIZE0      16    // small messages
+#define MEMPOOL_COUNT0     32
+#define MEMPOOL_SIZE1      64    // queue entries and small frames
+#define MEMPOOL_COUNT1     16
+#define MEMPOOL_SIZE2     256    // 64-sample frame buffers
+#define MEMPOOL_COUNT2      8
+
+// usage statistics for one pool class
+struct MemPoolStats{
+  uint32_t BlockSize;  // bytes per block
+  uint32_t NumBlocks;  // total blocks in this class
+  uint32_t Used;       // blocks currently allocated
+  uint32_t HighWater;  // largest value Used has ever had
+  uint32_t Allocs;     // number of successful allocations
+  uint32_t Failures;   // number of requests that found the class empty
+};
+typedef struct MemPoolStats MemPoolStatsType;
+
+// ******** MemPool_Init ************
+// Link every block of every class onto its free list
+// and clear the statistics
+// Inputs:  none
+// Outputs: none
+void MemPool_Init(void);
+
+// ******** MemPool_Alloc ************
+// Get one block from the smallest class that fits
+// Can be called from foreground threads and from ISRs
+// Inputs:  number of bytes needed
+// Outputs: pointer to the block, 0 if the class is empty
+//          or the request is larger than the largest class
+void *MemPool_Alloc(uint32_t size);
+
+// ******** MemPool_Free ************
+// Return a block obtained from MemPool_Alloc
+// Can be called from foreground threads and from ISRs
+// Inputs:  pointer to the block, 0 is ignored
+// Outputs: none
+void MemPool_Free(void *block);
+
+// ******** MemPool_Stats ************
+// Copy the statistics of one pool class
+// Inputs:  class number 0 to MEMPOOL_NUMCLASSES-1
+//          pointer to the structure to fill
+// Outputs: 1 if successful, 0 if the class does not exist
+int MemPool_Stats(uint32_t poolClass, MemPoolStatsType *stats);
+
+#endif // __MEMPOOL_H__
@@ -0,0 +1,47 @@
+// OSConfig.h
+// Runs on LM4F120/TM4C123
+// Compile-time kernel configuration.  Threads and periodic tasks
+// listed here are built into the kernel tables by os.h, so the
+// thread ring is linked by the compiler and the linker map shows
+// the RAM of every stack and table.  OS_AddThread and
+// OS_AddPeriodicThread still work for anything created at run time.
+// EE445M Lab 2
+
+#ifndef __OSCONFIG_H__ // do not include more than once
+#define __OSCONFIG_H__
+
+// 1 to start with the threads and tasks below, 0 for a kernel that
+// starts empty, as every test program in Lab2.c but main0 expects.
+// main0 runs either way, it adds the same threads itself when this is 0.
+// The static (1) path has not been run on the board yet
+#define OS_STATIC_CONFIG  0
+
+// DAS sampling period in system time units, 2 kHz, shared with Lab2.c
+#define PERIOD TIME_500US
+
+// foreground threads, in ring order, the first one runs first
+// OS_THREAD(task, pri)
+#define OS_CONFIG_THREADS \
+  OS_THREAD(Interpreter, 2) \
+  OS_THREAD(Consumer,    1) \
+  OS_THREAD(PID,         3)   /* Lab 3, make this lowest priority */
+
+// periodic background tasks, started by OS_Launch
+// OS_PERIODIC(task, period in 12.5ns units, pri)
+#define OS_CONFIG_PERIODIC \
+  OS_PERIODIC(DAS, PERIOD, 1)  /* 2 kHz real time sampling of PD3 */
+
+// words in the OS_Fifo buffer, the largest size OS_Fifo_Init accepts
+#define OS_CONFIG_FIFOSIZE  128
+
+// frames the frame channel can hold, power of 2
+#define OS_CONFIG_FRAMES  8
+
+#if !OS_STATIC_CONFIG
+#undef  OS_CONFIG_THREADS
+#define OS_CONFIG_THREADS
+#undef  OS_CONFIG_PERIODIC
+#define OS_CONFIG_PERIODIC
+#endif
+
+#endif // __OSCONFIG_H__
@@ -0,0 +1,103 @@
+// PID.c
+// Runs on LM4F120/TM4C123
+// Fixed-point PID controllers with anti-windup and a filtered
+// derivative.
+// EE445M Lab 2
+
+// Everything is kept in Q8 of the output, so the three terms add
+// with QADD and the command is (P+I+D)>>8, clamped to Min..Max.
+// The error is saturated to 16 bits and the gains are 16 bits, so
+// each product fits in 32 bits and is one SMULBB.
+// Anti-windup is conditional integration plus a clamp: while the
+// output sits at a limit, a step Ki*e that would push it further past
+// the limit is not integrated, whatever the sign of Ki, and the
+// integral alone never goes outside Min..Max.  Both are compares,
+// not loops, so the cost is fixed.
+// The derivative is D += Alpha*(Kd*(e-e1) - D), one pole at
+// 1-Alpha/32768, in 64 bits for the Alpha multiply.
+
+#include <stdint.h>
+#include "RamFunc.h"
+#include "PID.h"
+
+// ******** PID_Init ************
+// Set up one loop and clear its state
+// Inputs:  pointer to the loop
+//          kp ki kd gains, Q8, -32768 to 32767
+//          alpha derivative filter, Q15, PID_NOFILTER for none
+//          min max output limits, -8388608 to 8388607
+// Outputs: none
+void PID_Init(PIDType *pid, int32_t kp, int32_t ki, int32_t kd, int32_t alpha,
+              int32_t min, int32_t max){
+  pid->Kp = kp;
+  pid->Ki = ki;
+  pid->Kd = kd;
+  if(alpha < 1){
+    alpha = 1;
+  }
+  if(alpha > PID_NOFILTER){
+    alpha = PID_NOFILTER;
+  }
+  pid->Alpha = alpha;
+  pid->Min = min<<PID_SHIFT;
+  pid->Max = max<<PID_SHIFT;
+  PID_Reset(pid);
+}
+
+// ******** PID_Reset ************
+// Clear the integral and derivative history
+// Inputs:  pointer to the loop
+// Outputs: none
+void PID_Reset(PIDType *pid){
+  pid->Integral = 0;
+  pid->PrevError = 0;
+  pid->Deriv = 0;
+}
+
+// ******** PID_Step ************
+// Run one loop once, can be called from an ISR
+// Inputs:  pointer to the loop
+//          error setpoint minus measurement, saturated to -32768 to 32767
+// Outputs: actuator command, Min to Max
+RAMFUNC int32_t PID_Step(PIDType *pid, int32_t error){
+  int32_t p, i, d, u, step;
+  error = __ssat(error, 16);
+  p = __smulbb(pid->Kp, error);
+  d = __smulbb(pid->Kd, __ssat(error - pid->PrevError, 16));
+  pid->PrevError = error;
+  d = __qsub(d, pid->Deriv);
+  d = pid->Deriv + (int32_t)(((int64_t)d*pid->Alpha)>>15);
+  pid->Deriv = d;
+  i = pid->Integral;
+  u = __qadd(__qadd(p, i), d);
+  step = __smulbb(pid->Ki, error);
+  if(!(((u >= pid->Max) && (step > 0)) || ((u <= pid->Min) && (step < 0)))){
+    i = __qadd(i, step);                       // not winding up
+    if(i > pid->Max){
+      i = pid->Max;
+    } else if(i < pid->Min){
+      i = pid->Min;
+    }
+    pid->Integral = i;
+    u = __qadd(__qadd(p, i), d);
+  }
+  if(u > pid->Max){
+    u = pid->Max;
+  } else if(u < pid->Min){
+    u = pid->Min;
+  }
+  return u>>PID_SHIFT;
+}
+
+// ******** PID_StepN ************
+// Run n loops once each, can be called from an ISR
+// Inputs:  array of n loops
+//          errors n errors, errors[i] goes to pids[i]
+//          outs room for n commands, may be the same as errors
+//          n number of loops
+// Outputs: none
+RAMFUNC void PID_StepN(PIDType *pids, const int32_t *errors, int32_t *outs, uint32_t n){
+  for(; n; n--){
+    *outs++ = PID_Step(pids++, *errors++);
+  }
+}
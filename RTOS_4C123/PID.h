@@ -0,0 +1,75 @@
+// PID.h
+// Runs on LM4F120/TM4C123
+// Fixed-point PID controllers.  Each loop has its own state, so any
+// number of loops share the code, and PID_StepN runs a whole array of
+// loops in one call, e.g., every motor on the board from one
+// periodic task.
+// EE445M Lab 2
+
+// Unlike PID_stm32 in PID_stm32.s, which keeps its state in the
+// globals IntTerm and PrevError and wraps around in 16 bits, the
+// arithmetic here saturates (SSAT, QADD) instead of wrapping.
+// The integral is clamped to the output limits and stops growing
+// while the output is stuck at a limit (anti-windup), and the
+// derivative goes through a first order low pass so sensor noise
+// does not reach the actuator.
+// A step has no data-dependent loops and no divides, about 40 cycles
+// whatever the error, so a batch of N loops costs N times that.
+
+#ifndef __PID_H__ // do not include more than once
+#define __PID_H__
+#include <stdint.h>
+
+#define PID_SHIFT   8              // gains are Q8, 256 means 1.0
+#define PID_GAIN(x) ((int32_t)((x)*256))   // e.g., PID_GAIN(1.5) = 384
+#define PID_NOFILTER 32768         // derivative filter Alpha that passes everything
+
+// one control loop, set up with PID_Init
+struct PID{
+  int32_t Kp;          // proportional gain, Q8, -32768 to 32767
+  int32_t Ki;          // integral gain per step, Q8
+  int32_t Kd;          // derivative gain per step, Q8
+  int32_t Alpha;       // derivative low pass, Q15, 1 to PID_NOFILTER
+  int32_t Min;         // output limits, Q8
+  int32_t Max;
+  int32_t Integral;    // accumulated Ki*error, Q8, within Min to Max
+  int32_t PrevError;
+  int32_t Deriv;       // filtered Kd*(change in error), Q8
+};
+typedef struct PID PIDType;
+
+// ******** PID_Init ************
+// Set up one loop and clear its state
+// Inputs:  pointer to the loop
+//          kp ki kd gains, Q8, -32768 to 32767
+//          alpha derivative filter, Q15, PID_NOFILTER for none,
+//            smaller is smoother, the corner is about alpha*fs/(2pi*32768)
+//          min max output limits, -8388608 to 8388607
+// Outputs: none
+void PID_Init(PIDType *pid, int32_t kp, int32_t ki, int32_t kd, int32_t alpha,
+              int32_t min, int32_t max);
+
+// ******** PID_Reset ************
+// Clear the integral and derivative history, e.g., when the loop
+// is switched back on, the gains and limits stay
+// Inputs:  pointer to the loop
+// Outputs: none
+void PID_Reset(PIDType *pid);
+
+// ******** PID_Step ************
+// Run one loop once, can be called from an ISR
+// Inputs:  pointer to the loop
+//          error setpoint minus measurement, saturated to -32768 to 32767
+// Outputs: actuator command, Min to Max
+int32_t PID_Step(PIDType *pid, int32_t error);
+
+// ******** PID_StepN ************
+// Run n loops once each, can be called from an ISR
+// Inputs:  array of n loops
+//          errors n errors, errors[i] goes to pids[i]
+//          outs room for n commands, may be the same as errors
+//          n number of loops
+// Outputs: none
+void PID_StepN(PIDType *pids, const int32_t *errors, int32_t *outs, uint32_t n);
+
+#endif // __PID_H__
@@ -0,0 +1,25 @@
+// RamFunc.h
+// Runs on LM4F120/TM4C123
+// Marks time critical functions to run from SRAM.  Flash needs wait
+// states at 80 MHz, so code fetched from flash may take longer and
+// vary with prefetch buffer hits.  Functions marked RAMFUNC are
+// linked to SRAM and copied there from flash at startup, by __main
+// with RTOS.sct.  Keil armcc only, like the intrinsics in os.h.
+// EE445M Lab 2
+
+#ifndef __RAMFUNC_H__ // do not include more than once
+#define __RAMFUNC_H__
+
+// 0 to leave everything in flash, e.g., to compare the jitter
+// histogram with and without SRAM execution.  That comparison is
+// still to be done: build with 1 and with 0, run the DAS, and take
+// JitterHistogram with the interpreter's jitter command each time
+#define RAMFUNC_ENABLE  1
+
+#if RAMFUNC_ENABLE
+#define RAMFUNC __attribute__((section(".ramfunc")))   // RW_RAMCODE in RTOS.sct
+#else
+#define RAMFUNC
+#endif
+
+#endif // __RAMFUNC_H__
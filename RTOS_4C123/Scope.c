@@ -0,0 +1,194 @@
+// Scope.c
+// Runs on LM4F120/TM4C123
+// Oscilloscope style triggered capture.
+// EE445M Lab 2
+
+// The ring is written on every sample while armed, so at the trigger
+// the Pre samples before it are already in the ring.  Filled makes
+// sure they are, the trigger is ignored until Pre samples have come
+// in since Scope_Arm.  Once Post more samples have come the state is
+// SCOPE_DONE and Scope_Block stops writing, which freezes the record
+// without a copy.  The reader owns the ring until Scope_Arm, which
+// sets State last, so the ISR never sees a half armed capture.
+
+#include <stdint.h>
+#include "RamFunc.h"
+#include "ST7735.h"
+#include "UART.h"
+#include "Scope.h"
+
+// ******** Scope_Init ************
+// Set up a capture, not armed yet
+// Inputs:  pointer to the capture
+//          ring room for size samples
+//          size ring length, at least pre+post
+//          pre samples before the trigger, post samples from the trigger on
+//          mode SCOPE_RISING ... SCOPE_OUTSIDE
+//          low high thresholds, low <= high
+//          task runs in the ISR when the record is frozen, 0 for none
+// Outputs: 1 if successful, 0 on a bad length, mode or threshold
+int Scope_Init(ScopeType *s, uint16_t *ring, uint32_t size, uint32_t pre, uint32_t post,
+               uint32_t mode, int32_t low, int32_t high, void(*task)(void)){
+  s->State = SCOPE_IDLE;
+  if((post == 0) || (pre+post > size) || (mode > SCOPE_OUTSIDE) || (low > high)){
+    return 0;
+  }
+  s->Ring = ring;
+  s->Size = size;
+  s->Pre = pre;
+  s->Post = post;
+  s->Mode = mode;
+  s->Low = low;
+  s->High = high;
+  s->Task = task;
+  s->Head = 0;
+  s->Force = 0;
+  return 1;
+}
+
+// ******** Scope_Arm ************
+// Start looking for a trigger, history starts over
+// Inputs:  pointer to the capture
+// Outputs: none
+void Scope_Arm(ScopeType *s){
+  s->State = SCOPE_IDLE;         // the ISR leaves it alone while idle
+  s->Filled = 0;
+  s->Ready = 0;
+  s->Force = 0;
+  s->State = SCOPE_ARMED;
+}
+
+// ******** Scope_Force ************
+// Trigger on the next sample whatever the signal does
+// Inputs:  pointer to the capture
+// Outputs: none
+void Scope_Force(ScopeType *s){
+  s->Force = 1;
+}
+
+// trigger condition for one sample, edges also update Ready
+static int Scope_Trigger(ScopeType *s, int32_t x){
+  switch(s->Mode){
+    case SCOPE_RISING:
+      if(x < s->Low){
+        s->Ready = 1;
+      } else if(s->Ready && (x >= s->High)){
+        return 1;
+      }
+      return 0;
+    case SCOPE_FALLING:
+      if(x > s->High){
+        s->Ready = 1;
+      } else if(s->Ready && (x <= s->Low)){
+        return 1;
+      }
+      return 0;
+    case SCOPE_ABOVE:   return x >= s->High;
+    case SCOPE_BELOW:   return x <= s->Low;
+    case SCOPE_INSIDE:  return (x >= s->Low) && (x <= s->High);
+    default:            return (x < s->Low) || (x > s->High);
+  }
+}
+
+// ******** Scope_Block ************
+// Feed a block of samples, can be called from an ISR
+// Inputs:  pointer to the capture
+//          block n samples
+//          n number of samples
+// Outputs: 1 if this block froze the record
+RAMFUNC int Scope_Block(ScopeType *s, const uint16_t *block, uint32_t n){
+  uint32_t i, head = s->Head;
+  uint32_t state = s->State;
+  if((state == SCOPE_IDLE) || (state == SCOPE_DONE)){
+    return 0;
+  }
+  for(i = 0; i < n; i++){
+    s->Ring[head] = block[i];
+    if(state == SCOPE_ARMED){
+      if(s->Filled < s->Pre){
+        s->Filled++;             // still building the history
+        if(s->Mode <= SCOPE_FALLING){
+          Scope_Trigger(s, block[i]);  // edges still track Ready
+        }
+      } else if(Scope_Trigger(s, block[i]) || s->Force){
+        state = SCOPE_TRIGGERED;
+        s->Force = 0;
+        s->Remaining = s->Post;
+        s->Start = (head + s->Size - s->Pre)%s->Size;
+      }
+    }
+    head++;
+    if(head == s->Size){
+      head = 0;
+    }
+    if(state == SCOPE_TRIGGERED){
+      s->Remaining--;
+      if(s->Remaining == 0){
+        s->Head = head;
+        s->State = SCOPE_DONE;   // frozen
+        if(s->Task){
+          s->Task();
+        }
+        return 1;
+      }
+    }
+  }
+  s->Head = head;
+  s->State = state;
+  return 0;
+}
+
+// ******** Scope_Sample ************
+// One sample of a frozen record
+// Inputs:  pointer to the capture
+//          i 0 to Pre+Post-1, the trigger is sample Pre
+// Outputs: the sample
+uint16_t Scope_Sample(ScopeType *s, uint32_t i){
+  i += s->Start;
+  if(i >= s->Size){
+    i -= s->Size;
+  }
+  return s->Ring[i];
+}
+
+// ******** Scope_Plot ************
+// Draw a frozen record on the ST7735, 128 columns, decimated,
+// with a vertical line at the trigger
+// Inputs:  pointer to the capture
+//          ymin ymax plot range
+// Outputs: none
+void Scope_Plot(ScopeType *s, int32_t ymin, int32_t ymax){
+  uint32_t length = s->Pre + s->Post;
+  uint32_t x;
+  ST7735_PlotClear(ymin, ymax);
+  ST7735_DrawFastVLine((s->Pre*ST7735_TFTWIDTH)/length, 32, 128, ST7735_RED);
+  for(x = 0; x < ST7735_TFTWIDTH; x++){
+    ST7735_PlotLine(Scope_Sample(s, (x*length)/ST7735_TFTWIDTH));
+    ST7735_PlotNext();
+  }
+}
+
+static void Scope_OutHalfword(uint32_t n){
+  UART_OutChar(n&0xFF);
+  UART_OutChar((n>>8)&0xFF);
+}
+
+// ******** Scope_Send ************
+// Send a frozen record out UART0 as a binary record
+// Inputs:  pointer to the capture
+// Outputs: none
+void Scope_Send(ScopeType *s){
+  uint32_t length = s->Pre + s->Post;
+  uint32_t i, sample;
+  uint8_t sum = 0;
+  UART_OutChar(SCOPE_SYNC1);
+  UART_OutChar(SCOPE_SYNC2);
+  Scope_OutHalfword(length);
+  Scope_OutHalfword(s->Pre);
+  for(i = 0; i < length; i++){
+    sample = Scope_Sample(s, i);
+    Scope_OutHalfword(sample);
+    sum += sample + (sample>>8);
+  }
+  UART_OutChar(sum);
+}
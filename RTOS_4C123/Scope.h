@@ -0,0 +1,118 @@
+// Scope.h
+// Runs on LM4F120/TM4C123
+// Oscilloscope style triggered capture.  Samples go into a ring
+// continuously, a trigger condition is checked on every sample,
+// and a fixed number of samples after the trigger the ring freezes
+// with pre-trigger history in front of the trigger point.
+// The record can be plotted on the ST7735 or sent out UART0 in binary.
+// EE445M Lab 2
+
+// Scope_Block is made for the ADC_InitDMA block callback, it costs
+// a few cycles a sample and nothing once the record is frozen.
+// Triggers, Low <= High
+//   SCOPE_RISING   goes up to High after being below Low
+//   SCOPE_FALLING  goes down to Low after being above High
+//   SCOPE_ABOVE    any sample at or above High
+//   SCOPE_BELOW    any sample at or below Low
+//   SCOPE_INSIDE   any sample from Low to High
+//   SCOPE_OUTSIDE  any sample below Low or above High, glitch catcher
+// With Low < High the edges have Low..High of hysteresis, so noise
+// on a slow edge triggers once.
+
+#ifndef __SCOPE_H__ // do not include more than once
+#define __SCOPE_H__
+#include <stdint.h>
+
+#define SCOPE_RISING   0
+#define SCOPE_FALLING  1
+#define SCOPE_ABOVE    2
+#define SCOPE_BELOW    3
+#define SCOPE_INSIDE   4
+#define SCOPE_OUTSIDE  5
+
+#define SCOPE_IDLE     0   // not armed, the ring is not written
+#define SCOPE_ARMED    1   // filling the pre-trigger history, then waiting
+#define SCOPE_TRIGGERED 2  // collecting the post-trigger samples
+#define SCOPE_DONE     3   // record frozen, read it then Scope_Arm
+
+// binary record from Scope_Send, all 16-bit values little endian
+//   0xA5 0x5A, length, pre, length samples, sum of all sample bytes
+#define SCOPE_SYNC1    0xA5
+#define SCOPE_SYNC2    0x5A
+
+struct Scope{
+  uint16_t *Ring;          // Size samples
+  uint32_t Size;           // at least Pre+Post
+  uint32_t Head;           // next sample goes here
+  uint32_t Pre;            // samples kept before the trigger
+  uint32_t Post;           // samples kept from the trigger on
+  uint32_t Mode;           // SCOPE_RISING ... SCOPE_OUTSIDE
+  int32_t Low, High;       // thresholds, e.g., ADC counts
+  uint32_t Filled;         // history since arming, up to Pre
+  uint32_t Remaining;      // post-trigger samples still to come
+  uint32_t Start;          // ring index of the first record sample
+  uint32_t Ready;          // edge triggers, the signal was on the other side
+  volatile uint32_t State; // SCOPE_IDLE ... SCOPE_DONE
+  volatile uint32_t Force; // set by Scope_Force, trigger on the next sample
+  void (*Task)(void);      // runs in the ISR when the record is frozen
+};
+typedef struct Scope ScopeType;
+
+// ******** Scope_Init ************
+// Set up a capture, not armed yet
+// Inputs:  pointer to the capture
+//          ring room for size samples
+//          size ring length, at least pre+post
+//          pre samples before the trigger, post samples from the trigger on
+//          mode SCOPE_RISING ... SCOPE_OUTSIDE
+//          low high thresholds, low <= high
+//          task runs in the ISR when the record is frozen, 0 for none
+// Outputs: 1 if successful, 0 on a bad length, mode or threshold
+int Scope_Init(ScopeType *s, uint16_t *ring, uint32_t size, uint32_t pre, uint32_t post,
+               uint32_t mode, int32_t low, int32_t high, void(*task)(void));
+
+// ******** Scope_Arm ************
+// Start looking for a trigger, history starts over
+// Call before the first block and after reading each record
+// Inputs:  pointer to the capture
+// Outputs: none
+void Scope_Arm(ScopeType *s);
+
+// ******** Scope_Force ************
+// Trigger on the next sample whatever the signal does, e.g., to see
+// a signal that never reaches the threshold
+// Inputs:  pointer to the capture
+// Outputs: none
+void Scope_Force(ScopeType *s);
+
+// ******** Scope_Block ************
+// Feed a block of samples, can be called from an ISR
+// Inputs:  pointer to the capture
+//          block n samples
+//          n number of samples
+// Outputs: 1 if this block froze the record
+int Scope_Block(ScopeType *s, const uint16_t *block, uint32_t n);
+
+// ******** Scope_Sample ************
+// One sample of a frozen record
+// Inputs:  pointer to the capture
+//          i 0 to Pre+Post-1, the trigger is sample Pre
+// Outputs: the sample
+uint16_t Scope_Sample(ScopeType *s, uint32_t i);
+
+// ******** Scope_Plot ************
+// Draw a frozen record on the ST7735, 128 columns, decimated,
+// with a vertical line at the trigger
+// Inputs:  pointer to the capture
+//          ymin ymax plot range
+// Outputs: none
+void Scope_Plot(ScopeType *s, int32_t ymin, int32_t ymax);
+
+// ******** Scope_Send ************
+// Send a frozen record out UART0 as a binary record, about 4x faster
+// than decimal text, see SCOPE_SYNC1
+// Inputs:  pointer to the capture
+// Outputs: none
+void Scope_Send(ScopeType *s);
+
+#endif // __SCOPE_H__
@@ -0,0 +1,80 @@
+// Seqlock.c
+// Runs on LM4F120/TM4C123
+// Sequence lock for statistics written by an ISR and read by
+// foreground threads.
+// EE445M Lab 2
+
+// The data itself is not volatile, so the compiler could move the
+// writer's stores, or the reader's loads, past the sequence updates.
+// __dmb is both a hardware barrier and a compiler barrier in armcc
+// and keeps every access to the data between the two counter updates.
+
+#include <stdint.h>
+#include "Seqlock.h"
+
+// ******** Seq_Init ************
+// Sequence starts even, no update in progress
+// Inputs:  pointer to the lock
+// Outputs: none
+void Seq_Init(SeqLockType *s){
+  s->Sequence = 0;
+}
+
+// ******** Seq_WriteBegin ************
+// Call before changing the protected data, never blocks
+// Inputs:  pointer to the lock
+// Outputs: none
+void Seq_WriteBegin(SeqLockType *s){
+  s->Sequence = s->Sequence + 1;  // now odd
+  __dmb(0xF);
+}
+
+// ******** Seq_WriteEnd ************
+// Call after changing the protected data
+// Inputs:  pointer to the lock
+// Outputs: none
+void Seq_WriteEnd(SeqLockType *s){
+  __dmb(0xF);
+  s->Sequence = s->Sequence + 1;  // even again
+}
+
+// ******** Seq_ReadBegin ************
+// Call before copying the protected data
+// Inputs:  pointer to the lock
+// Outputs: sequence number to give to Seq_ReadRetry
+uint32_t Seq_ReadBegin(SeqLockType *s){
+  uint32_t seq = s->Sequence;
+  __dmb(0xF);
+  return seq;
+}
+
+// ******** Seq_ReadRetry ************
+// Call after copying the protected data
+// Inputs:  pointer to the lock
+//          value returned by Seq_ReadBegin
+// Outputs: 1 if the copy may be torn and must be repeated,
+//          0 if the copy is consistent
+int Seq_ReadRetry(SeqLockType *s, uint32_t seq){
+  __dmb(0xF);
+  return (seq&1) || (s->Sequence != seq);
+}
+
+// ******** Seq_Snapshot ************
+// Copy a block of protected data, retrying until consistent
+// Thread only, the writer must be able to finish between tries
+// Inputs:  pointer to the lock
+//          destination, source and number of bytes
+// Outputs: none
+void Seq_Snapshot(SeqLockType *s, void *dest, const volatile void *src, uint32_t size){
+  uint32_t seq, i;
+  uint8_t *pt;
+  const volatile uint8_t *from;
+  do{
+    seq = Seq_ReadBegin(s);
+    pt = dest;
+    from = src;
+    for(i = 0; i < size; i++){
+      pt[i] = from[i];
+    }
+  }while(Seq_ReadRetry(s, seq));
+}
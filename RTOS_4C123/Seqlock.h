@@ -0,0 +1,61 @@
+// Seqlock.h
+// Runs on LM4F120/TM4C123
+// Sequence lock for statistics written by an ISR and read by
+// foreground threads.  The writer never waits, it just bumps a
+// sequence counter before and after the update.  A reader copies
+// the data and tries again if the counter was odd (update in
+// progress) or changed while it was copying.
+// There must be only one writer per lock, or the writers must
+// not preempt each other, e.g. a single periodic task.
+// EE445M Lab 2
+
+#ifndef __SEQLOCK_H__ // do not include more than once
+#define __SEQLOCK_H__
+#include <stdint.h>
+
+struct SeqLock{
+  volatile uint32_t Sequence;  // odd while an update is in progress
+};
+typedef struct SeqLock SeqLockType;
+
+// ******** Seq_Init ************
+// Sequence starts even, no update in progress
+// Inputs:  pointer to the lock
+// Outputs: none
+void Seq_Init(SeqLockType *s);
+
+// ******** Seq_WriteBegin ************
+// Call before changing the protected data, never blocks
+// Inputs:  pointer to the lock
+// Outputs: none
+void Seq_WriteBegin(SeqLockType *s);
+
+// ******** Seq_WriteEnd ************
+// Call after changing the protected data
+// Inputs:  pointer to the lock
+// Outputs: none
+void Seq_WriteEnd(SeqLockType *s);
+
+// ******** Seq_ReadBegin ************
+// Call before copying the protected data
+// Inputs:  pointer to the lock
+// Outputs: sequence number to give to Seq_ReadRetry
+uint32_t Seq_ReadBegin(SeqLockType *s);
+
+// ******** Seq_ReadRetry ************
+// Call after copying the protected data
+// Inputs:  pointer to the lock
+//          value returned by Seq_ReadBegin
+// Outputs: 1 if the copy may be torn and must be repeated,
+//          0 if the copy is consistent
+int Seq_ReadRetry(SeqLockType *s, uint32_t seq);
+
+// ******** Seq_Snapshot ************
+// Copy a block of protected data, retrying until consistent
+// Thread only, the writer must be able to finish between tries
+// Inputs:  pointer to the lock
+//          destination, source and number of bytes
+// Outputs: none
+void Seq_Snapshot(SeqLockType *s, void *dest, const volatile void *src, uint32_t size);
+
+#endif // __SEQLOCK_H__
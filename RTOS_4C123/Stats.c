@@ -0,0 +1,196 @@
+// Stats.c
+// Runs on LM4F120/TM4C123
+// Streaming signal statistics.
+// EE445M Lab 2
+
+// The samples are integers, so plain sums of x and x*x in 64 bits
+// are exact, and a sample leaving the window is subtracted exactly.
+// Welford's update only earns its divide per sample in floating
+// point, here the round off happens once, in the reader.
+// The variance is E[x*x] - E[x]^2 with both terms in Q16, which
+// is plenty for 16-bit samples.
+// The decay accumulator keeps E[x] and E[x*x] as Q16 averages,
+//   m += (x - m)>>shift
+// Windowed min and max would need a sorted structure in the writer,
+// instead the reader scans the history inside its sequence lock.
+
+#include <stdint.h>
+#include "RamFunc.h"
+#include "Seqlock.h"
+#include "Stats.h"
+#include "FixMath.h"
+
+static void Stats_Clear(StatsType *s){
+  s->Count = 0;
+  s->Min = 0x7FFFFFFF;
+  s->Max = (int32_t)0x80000000;
+  s->Sum = 0;
+  s->SumSq = 0;
+  s->Index = 0;
+  s->EmaMean = 0;
+  s->EmaSq = 0;
+  s->Reset = 0;
+}
+
+// ******** Stats_Init ************
+// Set up a running accumulator
+// Inputs:  pointer to the accumulator
+// Outputs: none
+void Stats_Init(StatsType *s){
+  Seq_Init(&s->Lock);
+  s->Kind = STATS_RUNNING;
+  s->History = 0;
+  s->N = 0;
+  s->Shift = 0;
+  Stats_Clear(s);
+}
+
+// ******** Stats_InitWindow ************
+// Set up an accumulator over the last n samples
+// Inputs:  pointer to the accumulator
+//          history room for n samples
+//          n window length
+// Outputs: 1 if successful, 0 if n is 0
+int Stats_InitWindow(StatsType *s, int16_t *history, uint32_t n){
+  if(n == 0){
+    return 0;
+  }
+  Stats_Init(s);
+  s->Kind = STATS_WINDOW;
+  s->History = history;
+  s->N = n;
+  return 1;
+}
+
+// ******** Stats_InitDecay ************
+// Set up an exponentially weighted accumulator
+// Inputs:  pointer to the accumulator
+//          shift time constant 2^shift samples, 1 to 16
+// Outputs: 1 if successful, 0 on a bad shift
+int Stats_InitDecay(StatsType *s, uint32_t shift){
+  if((shift < 1) || (shift > 16)){
+    return 0;
+  }
+  Stats_Init(s);
+  s->Kind = STATS_DECAY;
+  s->Shift = shift;
+  return 1;
+}
+
+// ******** Stats_Step ************
+// Add one sample, can be called from an ISR, one writer per accumulator
+// Inputs:  pointer to the accumulator
+//          x sample, -32768 to 32767
+// Outputs: none
+RAMFUNC void Stats_Step(StatsType *s, int32_t x){
+  int32_t old;
+  Seq_WriteBegin(&s->Lock);
+  if(s->Reset){
+    Stats_Clear(s);
+  }
+  if(x < s->Min){
+    s->Min = x;
+  }
+  if(x > s->Max){
+    s->Max = x;
+  }
+  if(s->Kind == STATS_DECAY){
+    if(s->Count == 0){                 // start at the first sample, not at 0
+      s->EmaMean = (int64_t)x<<16;
+      s->EmaSq = (int64_t)(x*x)<<16;
+    } else{
+      s->EmaMean += (((int64_t)x<<16) - s->EmaMean)>>s->Shift;
+      s->EmaSq += (((int64_t)(x*x)<<16) - s->EmaSq)>>s->Shift;
+    }
+    s->Count++;
+  } else{
+    s->Sum += x;
+    s->SumSq += (uint32_t)(x*x);
+    if(s->Kind == STATS_WINDOW){
+      if(s->Count == s->N){            // full, the oldest sample leaves
+        old = s->History[s->Index];
+        s->Sum -= old;
+        s->SumSq -= (uint32_t)(old*old);
+      } else{
+        s->Count++;
+      }
+      s->History[s->Index] = (int16_t)x;
+      s->Index++;
+      if(s->Index == s->N){
+        s->Index = 0;
+      }
+    } else{
+      s->Count++;
+    }
+  }
+  Seq_WriteEnd(&s->Lock);
+}
+
+// ******** Stats_Reset ************
+// Start over, the writer clears the sums on its next sample
+// Inputs:  pointer to the accumulator
+// Outputs: none
+void Stats_Reset(StatsType *s){
+  s->Reset = 1;
+}
+
+// sum/n in Q16 without overflowing sum<<16
+static int64_t Stats_AverageQ16(int64_t sum, uint32_t n){
+  int64_t q = sum/n;
+  int64_t r = sum - q*n;
+  return (q<<16) + (r<<16)/n;
+}
+
+// ******** Stats_Snapshot ************
+// Consistent copy of the results, never blocks the writer
+// Inputs:  pointer to the accumulator
+//          pointer to the results to fill
+// Outputs: none
+void Stats_Snapshot(StatsType *s, StatsSnapshotType *snap){
+  uint32_t seq, count, i;
+  int32_t min, max, x;
+  int64_t sum, mean, square, variance;
+  uint64_t sumSq;
+  do{
+    seq = Seq_ReadBegin(&s->Lock);
+    count = s->Count;
+    min = s->Min;
+    max = s->Max;
+    sum = s->Sum;
+    sumSq = s->SumSq;
+    mean = s->EmaMean;
+    square = s->EmaSq;
+    if(s->Kind == STATS_WINDOW){       // min and max of what is in the window
+      min = 0x7FFFFFFF;
+      max = (int32_t)0x80000000;
+      for(i = 0; i < count; i++){
+        x = s->History[i];
+        if(x < min){
+          min = x;
+        }
+        if(x > max){
+          max = x;
+        }
+      }
+    }
+  }while(Seq_ReadRetry(&s->Lock, seq));
+  snap->Count = count;
+  if(count == 0){
+    snap->Mean = snap->StdDev = snap->Rms = snap->Min = snap->Max = 0;
+    return;
+  }
+  if(s->Kind != STATS_DECAY){
+    mean = Stats_AverageQ16(sum, count);
+    square = (int64_t)(sumSq/count)<<16;
+    square += (int64_t)(((sumSq%count)<<16)/count);
+  }
+  variance = square - ((mean*mean)>>16);
+  if(variance < 0){                    // round off with a constant input
+    variance = 0;
+  }
+  snap->Mean = (int32_t)(mean>>8);
+  snap->StdDev = FixMath_Sqrt64(variance);
+  snap->Rms = FixMath_Sqrt64(square);
+  snap->Min = min;
+  snap->Max = max;
+}
@@ -0,0 +1,98 @@
+// Stats.h
+// Runs on LM4F120/TM4C123
+// Streaming signal statistics, mean, standard deviation, RMS, min
+// and max, updated one sample at a time so diagnostics never have
+// to buffer raw data.  Cheap enough for a sample ISR.
+// EE445M Lab 2
+
+// Three kinds of accumulator
+//   running  everything since the start or the last Stats_Reset
+//   window   the last N samples, needs an N sample history
+//   decay    exponentially weighted, time constant 2^shift samples,
+//            min and max are since the last Stats_Reset
+// Each accumulator has its own sequence lock.  Stats_Step is the only
+// writer, e.g., one ISR, and Stats_Snapshot copies the sums and
+// computes the results in the reader, so the writer never waits.
+
+#ifndef __STATS_H__ // do not include more than once
+#define __STATS_H__
+#include <stdint.h>
+#include "Seqlock.h"
+
+#define STATS_RUNNING 0
+#define STATS_WINDOW  1
+#define STATS_DECAY   2
+
+struct Stats{
+  SeqLockType Lock;          // Stats_Step writes everything below under it
+  uint32_t Kind;             // STATS_RUNNING, STATS_WINDOW or STATS_DECAY
+  uint32_t Count;            // samples so far, at most N in a window
+  int32_t Min, Max;
+  int64_t Sum;               // running and window, sum of x
+  uint64_t SumSq;            //   sum of x*x
+  int16_t *History;          // window, last N samples
+  uint32_t N;
+  uint32_t Index;            //   oldest sample in History
+  uint32_t Shift;            // decay, time constant 2^Shift samples
+  int64_t EmaMean;           //   mean of x, Q16
+  int64_t EmaSq;             //   mean of x*x, Q16
+  volatile uint32_t Reset;   // set by Stats_Reset, cleared by the writer
+};
+typedef struct Stats StatsType;
+
+// results, computed by Stats_Snapshot
+struct StatsSnapshot{
+  uint32_t Count;            // samples in the result
+  int32_t Mean;              // Q8, 1/256 of an input unit
+  int32_t StdDev;            // Q8
+  int32_t Rms;               // Q8, includes the mean
+  int32_t Min, Max;          // input units
+};
+typedef struct StatsSnapshot StatsSnapshotType;
+
+// ******** Stats_Init ************
+// Set up a running accumulator
+// Inputs:  pointer to the accumulator
+// Outputs: none
+void Stats_Init(StatsType *s);
+
+// ******** Stats_InitWindow ************
+// Set up an accumulator over the last n samples
+// Inputs:  pointer to the accumulator
+//          history room for n samples
+//          n window length
+// Outputs: 1 if successful, 0 if n is 0
+int Stats_InitWindow(StatsType *s, int16_t *history, uint32_t n);
+
+// ******** Stats_InitDecay ************
+// Set up an exponentially weighted accumulator
+// Inputs:  pointer to the accumulator
+//          shift time constant 2^shift samples, 1 to 16
+// Outputs: 1 if successful, 0 on a bad shift
+int Stats_InitDecay(StatsType *s, uint32_t shift);
+
+// ******** Stats_Step ************
+// Add one sample, can be called from an ISR, one writer per accumulator
+// Running sums are exact, a running accumulator of 12-bit samples
+// is good for 2^31 samples
+// Inputs:  pointer to the accumulator
+//          x sample, -32768 to 32767, e.g., a 12-bit ADC value
+// Outputs: none
+void Stats_Step(StatsType *s, int32_t x);
+
+// ******** Stats_Reset ************
+// Start over, the writer clears the sums on its next sample,
+// can be called from any thread while the writer is running
+// Inputs:  pointer to the accumulator
+// Outputs: none
+void Stats_Reset(StatsType *s);
+
+// ******** Stats_Snapshot ************
+// Consistent copy of the results, never blocks the writer
+// Thread only, the writer must be able to finish between tries
+// Inputs:  pointer to the accumulator
+//          pointer to the results to fill, all 0 if there are no samples
+// Outputs: none
+void Stats_Snapshot(StatsType *s, StatsSnapshotType *snap);
+
+#endif // __STATS_H__
@@ -1,4 +1,5 @@
 #include "../inc/tm4c123gh6pm.h"
+#include "RamFunc.h"
 
 // fill these depending on your clock
 #define TIME_1MS  80000.0
@@ -35,7 +36,7 @@ void Timer0A_Init(void(*task)(void), uint32_t period, uint16_t priority){long sr
   EndCritical(sr);
 }
 
-void Timer0A_Handler(void){
+RAMFUNC void Timer0A_Handler(void){
   TIMER0_ICR_R = TIMER_ICR_TATOCINT;// acknowledge timer0A timeout
   (*PeriodicTask0A)();                // execute user task
 }
@@ -58,7 +59,7 @@ void Timer1A_Init(void(*task)(void), uint32_t period, uint16_t priority){
   TIMER1_CTL_R = 0x00000001;    // 10) enable TIMER1A
 }
 
-void Timer1A_Handler(void){
+RAMFUNC void Timer1A_Handler(void){
   TIMER1_ICR_R = TIMER_ICR_TATOCINT;// acknowledge TIMER1A timeout
   (*PeriodicTask1A)();                // execute user task
 }
@@ -0,0 +1,164 @@
+// Tone.c
+// Runs on LM4F120/TM4C123
+// Goertzel and sliding DFT single-bin detectors.
+// EE445M Lab 2
+
+// Goertzel runs the resonator s = x + 2cos(w)s1 - s2 for N samples,
+// then the bin is X = s1 - exp(-jw)s2, and the resonator starts over.
+// The sliding DFT keeps the bin of the last N samples up to date,
+//   S = r*exp(j2pi*k/N)*S + x - r^N*x[n-N]
+// The pole sits just inside the unit circle, r = 1-2^-16, so round
+// off in the Q30 rotation dies away instead of adding up forever,
+// and r^N in the comb keeps the response exactly N samples long.
+// There is no floating point, the cosines and square roots come
+// from FixMath.
+
+#include <stdint.h>
+#include "RamFunc.h"
+#include "Tone.h"
+#include "FixMath.h"
+
+#define TONE_R    (FIXMATH_Q30 - (FIXMATH_Q30>>16))    // 1-2^-16 in Q30
+
+// ******** Goertzel_Init ************
+// Set up a Goertzel detector, any frequencies below fs/2
+// Inputs:  pointer to the detector
+//          fs sampling rate in Hz
+//          freq numTones frequencies in Hz
+//          numTones 1 to TONE_MAXTONES
+//          n samples per result
+// Outputs: 1 if successful, 0 on a bad count or frequency
+int Goertzel_Init(GoertzelType *g, uint32_t fs, const uint32_t *freq, uint32_t numTones, uint32_t n){
+  uint32_t i, phase;
+  if((numTones == 0) || (numTones > TONE_MAXTONES) || (n < 2) || (fs == 0)){
+    return 0;
+  }
+  for(i = 0; i < numTones; i++){
+    if(2*freq[i] >= fs){
+      return 0;
+    }
+    phase = (uint32_t)(((uint64_t)freq[i]<<32)/fs);   // w in turns
+    g->Cos[i] = FixMath_Cos(phase)>>15;
+    g->Sin[i] = FixMath_Sin(phase)>>15;
+    g->S1[i] = 0;
+    g->S2[i] = 0;
+    g->Amplitude[i] = 0;
+    g->Re[i] = 0;
+    g->Im[i] = 0;
+  }
+  g->N = n;
+  g->Count = 0;
+  g->NumTones = numTones;
+  return 1;
+}
+
+// ******** Goertzel_Step ************
+// Add one sample, can be called from an ISR
+// Inputs:  pointer to the detector
+//          x sample, -32768 to 32767, e.g., a 12-bit ADC value
+// Outputs: 1 if this sample finished a block and Amplitude is new
+RAMFUNC int Goertzel_Step(GoertzelType *g, int32_t x){
+  uint32_t i;
+  int32_t s0, s1, s2, re, im;
+  for(i = 0; i < g->NumTones; i++){
+    s1 = g->S1[i];
+    s2 = g->S2[i];
+    s0 = x + (int32_t)(((int64_t)g->Cos[i]*s1)>>14) - s2;
+    g->S2[i] = s1;
+    g->S1[i] = s0;
+  }
+  g->Count++;
+  if(g->Count < g->N){
+    return 0;
+  }
+  for(i = 0; i < g->NumTones; i++){    // X = s1 - exp(-jw)*s2, scaled by 2/N
+    s1 = g->S1[i];
+    s2 = g->S2[i];
+    re = s1 - (int32_t)(((int64_t)g->Cos[i]*s2)>>15);
+    im = (int32_t)(((int64_t)g->Sin[i]*s2)>>15);
+    re = (int32_t)(2*(int64_t)re/(int32_t)g->N);
+    im = (int32_t)(2*(int64_t)im/(int32_t)g->N);
+    g->Re[i] = re;
+    g->Im[i] = im;
+    g->Amplitude[i] = FixMath_Sqrt((uint32_t)(re*re) + (uint32_t)(im*im));
+    g->S1[i] = 0;
+    g->S2[i] = 0;
+  }
+  g->Count = 0;
+  return 1;
+}
+
+// ******** SlidingDFT_Init ************
+// Set up a sliding DFT detector and clear its delay line
+// Inputs:  pointer to the detector
+//          fs sampling rate in Hz
+//          freq numTones frequencies in Hz, freq*n/fs whole numbers
+//          numTones 1 to TONE_MAXTONES
+//          n window length
+//          delay n samples for the delay line
+// Outputs: 1 if successful, 0 on a bad count or a frequency
+//          that is not a bin
+int SlidingDFT_Init(SlidingDFTType *d, uint32_t fs, const uint32_t *freq, uint32_t numTones,
+                    uint32_t n, int16_t *delay){
+  uint32_t i, k, phase;
+  int64_t rn;
+  if((numTones == 0) || (numTones > TONE_MAXTONES) || (n < 2) || (fs == 0)){
+    return 0;
+  }
+  for(i = 0; i < numTones; i++){
+    if(((freq[i]*n)%fs) || (2*freq[i] >= fs)){
+      return 0;                          // not a bin of the window
+    }
+    k = freq[i]*n/fs;
+    phase = (uint32_t)(((uint64_t)k<<32)/n);
+    d->RCos[i] = (int32_t)(((int64_t)FixMath_Cos(phase)*TONE_R)>>30);
+    d->RSin[i] = (int32_t)(((int64_t)FixMath_Sin(phase)*TONE_R)>>30);
+    d->Re[i] = 0;
+    d->Im[i] = 0;
+  }
+  rn = FIXMATH_Q30;
+  for(i = 0; i < n; i++){
+    rn = (rn*TONE_R)>>30;
+    delay[i] = 0;
+  }
+  d->RN = (int32_t)rn;
+  d->N = n;
+  d->Delay = delay;
+  d->Index = 0;
+  d->NumTones = numTones;
+  return 1;
+}
+
+// ******** SlidingDFT_Step ************
+// Add one sample and update every tone, can be called from an ISR
+// The state is kept in Q8 of the input units for the round off
+// Inputs:  pointer to the detector
+//          x sample, -2048 to 2047 for N up to 256
+// Outputs: none
+RAMFUNC void SlidingDFT_Step(SlidingDFTType *d, int32_t x){
+  uint32_t i;
+  int32_t re, im, comb;
+  comb = (x<<8) - (int32_t)(((int64_t)d->RN*(d->Delay[d->Index]<<8))>>30);
+  d->Delay[d->Index] = (int16_t)x;       // newest replaces oldest
+  d->Index++;
+  if(d->Index == d->N){
+    d->Index = 0;
+  }
+  for(i = 0; i < d->NumTones; i++){      // S = r*exp(j2pi*k/N)*(S) + comb
+    re = d->Re[i];
+    im = d->Im[i];
+    d->Re[i] = (int32_t)(((int64_t)d->RCos[i]*re - (int64_t)d->RSin[i]*im)>>30) + comb;
+    d->Im[i] = (int32_t)(((int64_t)d->RSin[i]*re + (int64_t)d->RCos[i]*im)>>30);
+  }
+}
+
+// ******** SlidingDFT_Amplitude ************
+// Amplitude of one tone over the last N samples, 2|S|/N
+// Inputs:  pointer to the detector
+//          tone 0 to NumTones-1
+// Outputs: amplitude in the units of the input
+uint32_t SlidingDFT_Amplitude(SlidingDFTType *d, uint32_t tone){
+  int32_t re = (int32_t)((2*(int64_t)d->Re[tone]/(int32_t)d->N)>>8);
+  int32_t im = (int32_t)((2*(int64_t)d->Im[tone]/(int32_t)d->N)>>8);
+  return FixMath_Sqrt((uint32_t)(re*re) + (uint32_t)(im*im));
+}
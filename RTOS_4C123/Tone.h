@@ -0,0 +1,101 @@
+// Tone.h
+// Runs on LM4F120/TM4C123
+// Single-bin tone detectors for a few chosen frequencies, much
+// cheaper than a full FFT when only those bins matter, e.g., 60 Hz
+// mains pickup and its harmonics.  Both run one sample at a time in
+// fixed point, so they fit in a sample ISR or a block callback.
+// EE445M Lab 2
+
+// Goertzel: about 10 cycles per sample per tone, a new amplitude
+// and phase every N samples.
+// Sliding DFT: about 20 cycles per sample per tone and an N sample
+// delay line shared by all tones, a new amplitude every sample, the
+// DFT bin of the last N samples.  The tone must be an exact bin,
+// freq*N/fs a whole number.
+// For comparison a 64 point FFT is several thousand cycles.
+// Amplitudes are in the units of the input, e.g., ADC counts, for a
+// sine of amplitude A the result is A.
+
+#ifndef __TONE_H__ // do not include more than once
+#define __TONE_H__
+#include <stdint.h>
+
+#define TONE_MAXTONES  4   // tones per detector
+
+// Goertzel detector, all tones share the block length N
+struct Goertzel{
+  uint32_t N;                          // samples per result
+  uint32_t Count;                      // samples so far in this block
+  uint32_t NumTones;
+  int32_t Cos[TONE_MAXTONES];          // cos(w) in Q15, also 2cos(w) in Q14
+  int32_t Sin[TONE_MAXTONES];          // sin(w) in Q15
+  int32_t S1[TONE_MAXTONES];           // filter state
+  int32_t S2[TONE_MAXTONES];
+  volatile uint32_t Amplitude[TONE_MAXTONES];  // results of the last block
+  volatile int32_t Re[TONE_MAXTONES];  // bin value times 2/N
+  volatile int32_t Im[TONE_MAXTONES];
+};
+typedef struct Goertzel GoertzelType;
+
+// sliding DFT detector, all tones share the window length N and its
+// delay line
+struct SlidingDFT{
+  uint32_t N;                          // window length
+  int16_t *Delay;                      // last N inputs
+  uint32_t Index;                      // oldest input in Delay
+  uint32_t NumTones;
+  int32_t RCos[TONE_MAXTONES];         // r*cos(2pi*k/N) in Q30
+  int32_t RSin[TONE_MAXTONES];         // r*sin(2pi*k/N) in Q30
+  int32_t RN;                          // r^N in Q30
+  int32_t Re[TONE_MAXTONES];           // bin value, N/2 times the amplitude
+  int32_t Im[TONE_MAXTONES];
+};
+typedef struct SlidingDFT SlidingDFTType;
+
+// ******** Goertzel_Init ************
+// Set up a Goertzel detector, any frequencies below fs/2
+// Inputs:  pointer to the detector
+//          fs sampling rate in Hz
+//          freq numTones frequencies in Hz
+//          numTones 1 to TONE_MAXTONES
+//          n samples per result, freq*n/fs should be close to a
+//            whole number to keep other tones and DC out
+// Outputs: 1 if successful, 0 on a bad count or frequency
+int Goertzel_Init(GoertzelType *g, uint32_t fs, const uint32_t *freq, uint32_t numTones, uint32_t n);
+
+// ******** Goertzel_Step ************
+// Add one sample, can be called from an ISR
+// Inputs:  pointer to the detector
+//          x sample, -32768 to 32767, e.g., a 12-bit ADC value
+// Outputs: 1 if this sample finished a block and Amplitude is new
+int Goertzel_Step(GoertzelType *g, int32_t x);
+
+// ******** SlidingDFT_Init ************
+// Set up a sliding DFT detector and clear its delay line
+// Inputs:  pointer to the detector
+//          fs sampling rate in Hz
+//          freq numTones frequencies in Hz, freq*n/fs whole numbers
+//          numTones 1 to TONE_MAXTONES
+//          n window length
+//          delay n samples for the delay line
+// Outputs: 1 if successful, 0 on a bad count or a frequency
+//          that is not a bin
+int SlidingDFT_Init(SlidingDFTType *d, uint32_t fs, const uint32_t *freq, uint32_t numTones,
+                    uint32_t n, int16_t *delay);
+
+// ******** SlidingDFT_Step ************
+// Add one sample and update every tone, can be called from an ISR
+// Inputs:  pointer to the detector
+//          x sample, -2048 to 2047 for N up to 256, e.g., a centered
+//            12-bit ADC value, larger inputs need a shorter window
+// Outputs: none
+void SlidingDFT_Step(SlidingDFTType *d, int32_t x);
+
+// ******** SlidingDFT_Amplitude ************
+// Amplitude of one tone over the last N samples
+// Inputs:  pointer to the detector
+//          tone 0 to NumTones-1
+// Outputs: amplitude in the units of the input
+uint32_t SlidingDFT_Amplitude(SlidingDFTType *d, uint32_t tone);
+
+#endif // __TONE_H__
@@ -27,7 +27,8 @@
 #define __OS_H  1
 
 #define NUMTHREADS  8        // maximum number of threads!
-#define STACKSIZE   100      // number of 32-bit words in stack
+#define STACKSIZE   104      // number of 32-bit words in stack, multiple of 8
+#define STACKGUARD  8        // lowest 32 bytes of each stack are a no-access MPU region
 
 
 #include <stdint.h>
@@ -41,6 +42,9 @@
 #include "Globals.h"
 #include "UART.h"
 #include "ST7735.h"
+#include "MemPool.h"
+#include "OSConfig.h"
+#include "RamFunc.h"
 
 #define NVIC_ST_CTRL_R          (*((volatile uint32_t *)0xE000E010))
 #define NVIC_ST_CTRL_CLK_SRC    0x00000004  // Clock Source
@@ -57,37 +61,154 @@ struct Sema4{
 };
 typedef struct Sema4 Sema4Type;
 
+// condition variable, always used together with a binary semaphore
+// that protects the state being waited on
+struct CondVar{
+  Sema4Type Sema;   // waiters block here
+  int16_t Waiters;  // threads in OS_CondWait, changed only under the mutex
+};
+typedef struct CondVar CondVarType;
+
+// reader-writer lock, many readers or one writer
+// writer preferring: new readers wait while any writer is waiting
+struct RWLock{
+  Sema4Type Mutex;       // protects the fields below
+  CondVarType ReadOK;
+  CondVarType WriteOK;
+  int16_t Readers;       // readers holding the lock
+  int16_t Writer;        // 1 if a writer holds the lock
+  int16_t WaitingWriters;
+};
+typedef struct RWLock RWLockType;
+
 // function definitions in osasm.s
 void OS_DisableInterrupts(void); // Disable interrupts
 void OS_EnableInterrupts(void);  // Enable interrupts
 int32_t StartCritical(void);
 void EndCritical(int32_t primask);
 void StartOS(void);
+void StartOSCoop(void);
+void OS_Yield(void);
+uint32_t OS_InISR(void);
+uint32_t OS_Unprivileged(void);
+// SVC stubs in osasm.s, unprivileged threads enter the kernel through
+// these, SVC_Handler dispatches SVC #n to OS_SVCTable[n] below
+void SVC_Suspend(void);
+void SVC_Sleep(uint64_t time);
+void SVC_Kill(void);
+bool SVC_AddThread(void(*task)(void), uint16_t priority);
+bool SVC_AddPeriodicThread(void(*task)(void), uint32_t period, uint16_t priority);
+void SVC_Signal(Sema4Type *s);
+void SVC_bSignal(Sema4Type *s);
+int SVC_TryWait(Sema4Type *s);
+int SVC_TrybWait(Sema4Type *s);
+int SVC_ADCCollect(uint32_t channelNum, uint32_t fs, uint16_t *buffer, uint32_t numberOfSamples);
 void ContextSwitch(void);
 void OS_bSignal(Sema4Type *semaPt);
 void OS_bWait(Sema4Type *semaPt);
 void OS_Signal(Sema4Type *s);
 void SysTick_Init(uint32_t period, uint32_t priority);
-bool timer_occupied[4] = {false};
-void (*timer_init_fns[4]) (void(*task)(void), uint32_t period, uint16_t priority);
+// Timer0 triggers the ADC, Timer2 is the OS clock
+static bool timer_occupied[4] = {true, false, true, false};
+static void (* const timer_init_fns[4]) (void(*task)(void), uint32_t period, uint16_t priority) = {
+	&Timer0A_Init, &Timer1A_Init, &Timer2A_Init, &Timer3A_Init
+};
 void OS_ClearMsTime(void);
 unsigned long OS_TimeDifference(unsigned long start, unsigned long stop);
 unsigned long OS_Time(void);
-Sema4Type Mutex;
-Sema4Type DataAvailable;
-Sema4Type MailboxFull;
-Sema4Type MailboxEmpty;
+static Sema4Type Mutex = {1};
+static Sema4Type DataAvailable = {0};
+static Sema4Type MailboxFull = {0};
+static Sema4Type MailboxEmpty = {1};
+static Sema4Type FramesAvailable = {0};
+
+// bursts queued with OS_ADC_Collect, oldest first, each with the
+// semaphore of the thread that queued it.  The driver finishes
+// bursts in order, so the oldest entry is the next to finish, unless
+// the burst that finished was queued with ADC_Collect directly and
+// has no entry.  Power of 2, at least the driver's queue of 4
+#define OS_ADCWAITERS 4
+static uint16_t *ADCWaitBuf[OS_ADCWAITERS];
+static Sema4Type *ADCWaitSema[OS_ADCWAITERS];
+static uint32_t ADCWaitPut;
+static uint32_t ADCWaitGet;
+int ADC_Collect(uint32_t channelNum, uint32_t fs, uint16_t *buffer, uint32_t numberOfSamples);
+int ADC_Stop(void);
+void ADC_CollectHook(void(*task)(uint16_t *buffer, uint32_t count));
+static void OS_ADCCollected(uint16_t *buffer, uint32_t count) {
+	uint32_t get = ADCWaitGet&(OS_ADCWAITERS-1);
+	if((ADCWaitGet != ADCWaitPut) && (ADCWaitBuf[get] == buffer)) {
+		ADCWaitGet++;
+		OS_Signal(ADCWaitSema[get]);
+	}
+}
+
+// comparators that fired since the last OS_ADC_WaitAlarm, set by
+// the ADC0 SS2 ISR, binary semaphore so events merge into the flags
+static Sema4Type ADCAlarm = {0};
+static volatile uint32_t ADCAlarms;
+int ADC_ArmComparator(uint32_t comp);
+void ADC_ComparatorHook(void(*task)(uint32_t comps));
+static void OS_ADCAlarm(uint32_t comps) {
+	ADCAlarms |= comps;
+	OS_bSignal(&ADCAlarm);
+}
 
 struct tcb{
   int32_t *sp;       // pointer to stack (valid for threads not running
   struct tcb *next;  // linked-list pointer
 	uint64_t sleep_start; // when we fell asleep
 	uint64_t sleep_time; // how long to sleep
-	int16_t priority;  // higher is more important, -1 means 
+	int16_t priority;  // 0 is most important, higher is less, like OS_AddSW1Task
+	Sema4Type *blocked; // semaphore we are waiting on, 0 if none
+	int32_t *stack;     // lowest address of the stack, start of the guard
+	bool active;        // slot holds a live thread, false in unused slots
+	Sema4Type adc_done; // one signal per finished OS_ADC_Collect burst
 };
 typedef struct tcb tcbType;
-tcbType tcbs[NUMTHREADS];
-tcbType *RunPt;
+
+// threads from OSConfig.h take the first slots, in ring order
+#define OS_THREAD(task, pri) void task(void);
+OS_CONFIG_THREADS
+#undef OS_THREAD
+#define OS_PERIODIC(task, period, pri) void task(void);
+OS_CONFIG_PERIODIC
+#undef OS_PERIODIC
+enum{
+#define OS_THREAD(task, pri) OS_TID_##task,
+OS_CONFIG_THREADS
+#undef OS_THREAD
+	OS_NUM_STATIC_THREADS
+};
+
+static __align(32) int32_t Stacks[NUMTHREADS][STACKSIZE];  // MPU regions are size aligned
+#if OS_STATIC_CONFIG
+static tcbType tcbs[NUMTHREADS] = {
+#define OS_THREAD(task, pri) \
+	[OS_TID_##task] = { .next = &tcbs[(OS_TID_##task+1)%OS_NUM_STATIC_THREADS], \
+	                    .priority = pri, .stack = Stacks[OS_TID_##task], .active = true },
+OS_CONFIG_THREADS
+#undef OS_THREAD
+};
+#else
+static tcbType tcbs[NUMTHREADS];  // zeroed, every slot starts empty
+#endif
+tcbType *RunPt = OS_NUM_STATIC_THREADS ? &tcbs[0] : 0;  // first static thread runs first
+
+// idle thread, runs only when every other thread sleeps or blocks
+// it is not in the tcbs[] ring, the scheduler switches to it directly
+static __align(32) int32_t IdleStack[STACKSIZE];
+static tcbType IdleTcb = {
+	.priority = 0x7FFF,  // largest int16_t, lowest priority, never in the ring
+	.stack = IdleStack,
+	.active = true
+};
+void WaitForInterrupt(void);  // low power mode, in startup.s
+void (*OS_IdleHook)(void) = &WaitForInterrupt;
+unsigned long IdleCount;      // number of idle loop iterations
+bool IdleRunning;             // true while IdleTcb holds the CPU
+unsigned long IdleStart;      // OS_Time when idle thread was switched in
+unsigned long IdleTime;       // idle time in current 1 s window, 12.5ns units
 
 //Function prototyping
 void OS_bSignal(Sema4Type *s);
@@ -97,15 +218,15 @@ void OS_bWait(Sema4Type *s);
 void OS_InitSemaphore(Sema4Type *semaPt, uint16_t value);
 
 void tcb_set_empty(tcbType *tcbobj){
-	tcbobj->priority = -1;
+	tcbobj->active = false;
 }
 
 bool tcb_is_empty(tcbType tcbobj){
 	// by empty, i mean hosting a null thread
-	// use priority = -1 as a flag to indicate
-	// a slot in tcbs that doesn't hold an active
-	// thread
-	return tcbobj.priority == -1;
+	// active is false in a slot in tcbs that
+	// doesn't hold a live thread, so the zeroed
+	// slots past the static threads start empty
+	return !tcbobj.active;
 }	
 
 bool tcbs_all_empty(){
@@ -131,25 +252,106 @@ void Switch_Int(void){
 	
 }
 
-int32_t Stacks[NUMTHREADS][STACKSIZE];
+bool preemptive_mode;  // need to remember mode
+
+//******** Stack guard ***************
+// MPU region 7 covers the lowest STACKGUARD words of the running
+// thread's stack with no access for anyone, privileged included.
+// An overflow, or the hardware stacking an exception frame past the
+// end, raises MemManage before a neighbor's stack is corrupted.
+// Only the running thread can grow its stack, so one region moved on
+// every context switch protects all of them, at no cost between switches.
+// PRIVDEFENA gives the default memory map to privileged code only,
+// and threads run unprivileged, so regions 0 to 2 open up the memory
+// they need: flash read and execute, SRAM read, write and execute
+// for the RAMFUNC code, and the peripherals read and write.  The
+// higher numbered guard wins where it overlaps SRAM.
+#define MPU_FLASH_REGION   0
+#define MPU_SRAM_REGION    1
+#define MPU_PERIPH_REGION  2
+#define MPU_GUARD_REGION   7
+#define MPU_RASR_XN        0x10000000  // no instruction fetch
+#define MPU_RASR_AP_NONE   0x00000000  // no access, privileged or not
+#define MPU_RASR_AP_RW     0x03000000  // read and write, privileged or not
+#define MPU_RASR_AP_RO     0x06000000  // read only, privileged or not
+#define MPU_RASR_FLASH     0x00020000  // C, normal memory
+#define MPU_RASR_SRAM      0x00070000  // S C B, normal shared memory
+#define MPU_RASR_DEVICE    0x00050000  // S B, shared device
+#define MPU_RASR_SIZE_32B  (4<<1)      // 2^(4+1) = 32 bytes
+#define MPU_RASR_SIZE_32K  (14<<1)     // SRAM, 0x20000000 to 0x20007FFF
+#define MPU_RASR_SIZE_256K (17<<1)     // flash, 0x00000000 to 0x0003FFFF
+#define MPU_RASR_SIZE_512M (28<<1)     // peripherals, 0x40000000 to 0x5FFFFFFF
+#define MPU_RASR_ENABLE    0x00000001
+#define MPU_RBAR_VALID     0x00000010  // use region number in RBAR
+#define MPU_CTRL_ENABLE    0x00000001
+#define MPU_CTRL_PRIVDEFEN 0x00000004  // default memory map for privileged code
+
+void OS_MPU_Init(void){
+	NVIC_MPU_CTRL_R = 0;
+	NVIC_MPU_BASE_R = 0x00000000|MPU_RBAR_VALID|MPU_FLASH_REGION;
+	NVIC_MPU_ATTR_R = MPU_RASR_AP_RO|MPU_RASR_FLASH|MPU_RASR_SIZE_256K|MPU_RASR_ENABLE;
+	NVIC_MPU_BASE_R = 0x20000000|MPU_RBAR_VALID|MPU_SRAM_REGION;
+	NVIC_MPU_ATTR_R = MPU_RASR_AP_RW|MPU_RASR_SRAM|MPU_RASR_SIZE_32K|MPU_RASR_ENABLE;
+	NVIC_MPU_BASE_R = 0x40000000|MPU_RBAR_VALID|MPU_PERIPH_REGION;
+	NVIC_MPU_ATTR_R = MPU_RASR_XN|MPU_RASR_AP_RW|MPU_RASR_DEVICE|MPU_RASR_SIZE_512M|MPU_RASR_ENABLE;
+	NVIC_MPU_NUMBER_R = MPU_GUARD_REGION;
+	NVIC_MPU_ATTR_R = 0;                // off until the first switch
+	NVIC_MPU_CTRL_R = MPU_CTRL_ENABLE|MPU_CTRL_PRIVDEFEN;
+	NVIC_SYS_HND_CTRL_R |= NVIC_SYS_HND_CTRL_MEM;  // MemManage, not HardFault
+}
+
+// move the guard below the stack of the thread about to run
+RAMFUNC void OS_MPU_SetGuard(tcbType *tcb){
+	NVIC_MPU_BASE_R = ((uint32_t)tcb->stack)|MPU_RBAR_VALID|MPU_GUARD_REGION;
+	NVIC_MPU_ATTR_R = MPU_RASR_XN|MPU_RASR_AP_NONE|MPU_RASR_SIZE_32B|MPU_RASR_ENABLE;
+}
+
+void SetInitialStackPt(tcbType *tcb, int32_t *stack){
+  if(!preemptive_mode){  // cooperative, frame popped by OS_Yield
+    tcb->sp = &stack[STACKSIZE-10];    // thread stack pointer, SP 8-aligned after the pop
+    stack[STACKSIZE-1] = 0x14141414;   // LR, start location set by SetInitialPC
+    stack[STACKSIZE-2] = 0x11111111;   // R11
+    stack[STACKSIZE-3] = 0x10101010;   // R10
+    stack[STACKSIZE-4] = 0x09090909;   // R9
+    stack[STACKSIZE-5] = 0x08080808;   // R8
+    stack[STACKSIZE-6] = 0x07070707;   // R7
+    stack[STACKSIZE-7] = 0x06060606;   // R6
+    stack[STACKSIZE-8] = 0x05050505;   // R5
+    stack[STACKSIZE-9] = 0x04040404;   // R4
+    stack[STACKSIZE-10] = 0x00000000;  // PRIMASK, interrupts enabled
+    return;
+  }
+  tcb->sp = &stack[STACKSIZE-16];      // thread stack pointer
+  stack[STACKSIZE-1] = 0x01000000;     // thumb bit
+  stack[STACKSIZE-3] = 0x14141414;     // R14  
+  stack[STACKSIZE-4] = 0x12121212;     // R12	 
+  stack[STACKSIZE-5] = 0x03030303;     // R3
+  stack[STACKSIZE-6] = 0x02020202;     // R2
+  stack[STACKSIZE-7] = 0x01010101;     // R1
+  stack[STACKSIZE-8] = 0x00000000;     // R0
+  stack[STACKSIZE-9] = 0x11111111;     // R11
+  stack[STACKSIZE-10] = 0x10101010;    // R10
+  stack[STACKSIZE-11] = 0x09090909;    // R9
+  stack[STACKSIZE-12] = 0x08080808;    // R8
+  stack[STACKSIZE-13] = 0x07070707;    // R7
+  stack[STACKSIZE-14] = 0x06060606;    // R6
+  stack[STACKSIZE-15] = 0x05050505;    // R5
+  stack[STACKSIZE-16] = 0x04040404;    // R4
+}
+
+// where the thread starts, the LR popped by OS_Yield in cooperative
+// mode, the PC popped by the exception return in preemptive mode
+void SetInitialPC(int32_t *stack, void(*task)(void)){
+  if(!preemptive_mode){
+    stack[STACKSIZE-1] = (int32_t)task;
+  } else{
+    stack[STACKSIZE-2] = (int32_t)task;
+  }
+}
 
 void SetInitialStack(int i){
-  tcbs[i].sp = &Stacks[i][STACKSIZE-16]; // thread stack pointer
-  Stacks[i][STACKSIZE-1] = 0x01000000;   // thumb bit
-  Stacks[i][STACKSIZE-3] = 0x14141414;   // R14  
-  Stacks[i][STACKSIZE-4] = 0x12121212;   // R12	 
-  Stacks[i][STACKSIZE-5] = 0x03030303;   // R3
-  Stacks[i][STACKSIZE-6] = 0x02020202;   // R2
-  Stacks[i][STACKSIZE-7] = 0x01010101;   // R1
-  Stacks[i][STACKSIZE-8] = 0x00000000;   // R0
-  Stacks[i][STACKSIZE-9] = 0x11111111;   // R11
-  Stacks[i][STACKSIZE-10] = 0x10101010;  // R10
-  Stacks[i][STACKSIZE-11] = 0x09090909;  // R9
-  Stacks[i][STACKSIZE-12] = 0x08080808;  // R8
-  Stacks[i][STACKSIZE-13] = 0x07070707;  // R7
-  Stacks[i][STACKSIZE-14] = 0x06060606;  // R6
-  Stacks[i][STACKSIZE-15] = 0x05050505;  // R5
-  Stacks[i][STACKSIZE-16] = 0x04040404;  // R4
+  SetInitialStackPt(&tcbs[i], Stacks[i]);
+  tcbs[i].stack = Stacks[i];
 }
 
 uint64_t OS_ISR_period;
@@ -159,18 +361,30 @@ uint64_t OS_Clock_Period = TIME_1MS;
 int OS_Clock_Priority = 3; 
 unsigned long OS_Clock_Time;
 
-uint32_t OS_Fifo[128];
-int OS_Fifo_First;
-int OS_Fifo_Last;
-int OS_Fifo_Length;
-unsigned long Mailbox; 
+static uint32_t OS_Fifo[OS_CONFIG_FIFOSIZE];
+static int OS_Fifo_First;
+static int OS_Fifo_Last;
+static int OS_Fifo_Length = OS_CONFIG_FIFOSIZE;
+static unsigned long Mailbox; 
 
 
 /********* OS_Suspend **************
 Stop execution of currently active
 foreground thread. Move on to next.
+Cooperative mode switches directly with
+OS_Yield, no exception is involved.
 ************************************/
 void OS_Suspend(void){
+	if(OS_Unprivileged()){     // SysTick registers are privileged
+		SVC_Suspend();
+		return;
+	}
+	if(!preemptive_mode){
+		if(OS_InISR() == 0){     // an ISR can not switch threads
+			OS_Yield();
+		}
+		return;
+	}
 	NVIC_ST_CURRENT_R = 0;  // clear counter
 	NVIC_INT_CTRL_R = 0x04000000;  // trigger systick
 }
@@ -188,16 +402,114 @@ void OS_InitSemaphore(Sema4Type *semaPt, uint16_t value){
 what to run on systick interrupt
 ********************************/
 void OS_ISR(void);
+
+// CPU load, in 0.1% units, over the last 1 s and
+// exponentially decayed over 10 s and 60 s, like Unix loadavg
+uint32_t OS_LoadTicks;         // ms into the current 1 s window
+unsigned long OS_LoadStart;    // OS_Time at start of the window
+uint32_t OS_Load1;             // busy fraction of the last second
+uint64_t OS_Load10;            // 10 s average, 0.1% units << 16
+uint64_t OS_Load60;            // 60 s average, 0.1% units << 16
+#define LOAD_EXP10  59299      // 65536*exp(-1/10)
+#define LOAD_EXP60  64453      // 65536*exp(-1/60)
+
+// ******** OS_UpdateLoad ************
+// close the current 1 s window and update the load averages
+// called from OS_Clock_ISR once per second
+void OS_UpdateLoad(void){
+	unsigned long now, idle, window;
+	int32_t status;
+	status = StartCritical();
+	now = OS_Time();
+	idle = IdleTime;
+	if(IdleRunning){           // count the part of this idle stretch so far
+		idle += now - IdleStart;
+		IdleStart = now;
+	}
+	IdleTime = 0;
+	EndCritical(status);
+	window = (now - OS_LoadStart)/1000;
+	OS_LoadStart = now;
+	if(window == 0){ return; }
+	idle = idle/window;        // idle in 0.1% units
+	if(idle > 1000){ idle = 1000; }
+	OS_Load1 = 1000 - idle;
+	OS_Load10 = (OS_Load10*LOAD_EXP10 + ((uint64_t)OS_Load1<<16)*(65536-LOAD_EXP10))>>16;
+	OS_Load60 = (OS_Load60*LOAD_EXP60 + ((uint64_t)OS_Load1<<16)*(65536-LOAD_EXP60))>>16;
+}
+
+// ******** OS_CPULoad ************
+// report how busy the processor has been
+// Inputs:  averaging window in seconds, 1 10 or 60
+// Outputs: load in 0.1% units, 0 to 1000
+uint32_t OS_CPULoad(uint32_t seconds){
+	if(seconds >= 60){
+		return (uint32_t)(OS_Load60>>16);
+	}
+	if(seconds >= 10){
+		return (uint32_t)(OS_Load10>>16);
+	}
+	return OS_Load1;
+}
+
 void OS_Clock_ISR(void) {
 	OS_Clock_Time++;
+	OS_LoadTicks++;
+	if(OS_LoadTicks == 1000){  // 1 s windows
+		OS_LoadTicks = 0;
+		OS_UpdateLoad();
+	}
 }
 
+// ******** OS_Idle ************
+// idle thread, lowest priority, never sleeps or blocks
+// counts loops and calls the low power hook
+void OS_Suspend(void);
+void OS_Idle(void){
+	for(;;){
+		IdleCount++;
+		if(OS_IdleHook){
+			(*OS_IdleHook)();      // e.g., WFI until the next interrupt
+		}
+		if(!preemptive_mode){
+			OS_Suspend();          // cooperative, give others a chance
+		}
+	}
+}
+
+// ******** OS_SetIdleHook ************
+// select the function the idle thread calls every loop,
+// typically used to enter a low power mode
+// Inputs:  pointer to a void/void function, 0 for none
+// Outputs: none
+void OS_SetIdleHook(void(*hook)(void)){
+	OS_IdleHook = hook;
+}
+
+//******** Vector table in SRAM ***************
+// the flash table is read on every exception entry, the SRAM
+// copy is not subject to flash wait states
+#define OS_NUMVECTORS  155         // 16 system + 139 interrupts
+extern uint32_t __Vectors[];       // flash vector table, in startup.s
+static __align(1024) uint32_t OS_RamVectors[OS_NUMVECTORS] __attribute__((section(".vtable"), zero_init));
+
+// ******** OS_RelocateVectors ************
+// copy the vector table to SRAM and point VTOR at it
+// call with interrupts disabled
+void OS_RelocateVectors(void){
+	for(uint32_t i = 0; i < OS_NUMVECTORS; i++){
+		OS_RamVectors[i] = __Vectors[i];
+	}
+	NVIC_VTABLE_R = (uint32_t)OS_RamVectors;
+	__dsb(0xF);                // new table is used from the next exception
+}
 
-bool preemptive_mode;  // need to remember mode
 // ******** OS_Init ************
 // initialize operating system, disable interrupts until OS_Launch
 // initialize OS controlled I/O: systick, 50 MHz PLL
 // input:  bool preemptive - whether to init isr
+//         false selects cooperative mode, threads switch only
+//         when they call OS_Suspend (or wait, sleep, kill)
 // output: none
 void OS_Init(bool preemptive){
   OS_DisableInterrupts();
@@ -208,19 +520,28 @@ void OS_Init(bool preemptive){
   NVIC_ST_CTRL_R = 0;         // disable SysTick during setup
   NVIC_ST_CURRENT_R = 0;      // any write to current clears it
   NVIC_SYS_PRI3_R =(NVIC_SYS_PRI3_R&0x00FFFFFF)|0xE0000000; // priority 7
-	for (uint16_t i = 0; i < NUMTHREADS; i++){
-		tcbs[i].priority = -1;
-	}
+	OS_RelocateVectors();       // before any handler is installed or enabled
+	// the ring is linked at compile time, only the initial stack
+	// frames depend on the mode, one unrolled store per thread
+#define OS_THREAD(task, pri) \
+	SetInitialStack(OS_TID_##task); \
+	SetInitialPC(Stacks[OS_TID_##task], &task);
+	OS_CONFIG_THREADS
+#undef OS_THREAD
+	MemPool_Init();             // message and frame buffer pools
+	ADC_CollectHook(&OS_ADCCollected);
+	ADC_ComparatorHook(&OS_ADCAlarm);
+	OS_MPU_Init();              // stack guard, armed by OS_Launch
+	SetInitialStackPt(&IdleTcb, IdleStack);
+	SetInitialPC(IdleStack, &OS_Idle);
+	IdleRunning = false;
+	IdleTime = 0;
+	OS_LoadTicks = 0;
+	OS_LoadStart = 0;
 	OS_ClearMsTime();
-	timer_init_fns[0] = &Timer0A_Init;
-	timer_occupied[0] = true;
-	timer_init_fns[1] = &Timer1A_Init;
-	timer_init_fns[2] = &Timer2A_Init;
-	timer_init_fns[3] = &Timer3A_Init;
 	
 		// Periodic Clock Task
 	OS_Clock_Time = 0;
-	timer_occupied[2] = true;
 	timer_init_fns[2](&OS_Clock_ISR, OS_Clock_Period, OS_Clock_Priority);
 
 }
@@ -231,6 +552,9 @@ void OS_Init(bool preemptive){
 // Outputs: 1 if successful, 0 if this thread can not be added
 bool OS_AddThread(void(*task)(void), uint16_t priority){ 
 	int32_t status;
+	if(OS_Unprivileged()){
+		return SVC_AddThread(task, priority);
+	}
   status = StartCritical();
 	if (tcbs_all_full()){ 
 	assert(false);
@@ -238,6 +562,7 @@ bool OS_AddThread(void(*task)(void), uint16_t priority){
 	} // no room
 	int16_t new_tcb_index = -1;
 	bool found_free = false;
+	bool first = tcbs_all_empty();  // before this slot goes live
 	while(!found_free && new_tcb_index < NUMTHREADS){
 		new_tcb_index++;
 		found_free = tcb_is_empty(tcbs[new_tcb_index]);
@@ -245,13 +570,21 @@ bool OS_AddThread(void(*task)(void), uint16_t priority){
 	SetInitialStack(new_tcb_index);
 	tcbs[new_tcb_index].sleep_start = 0;
 	tcbs[new_tcb_index].sleep_time = 0;
-	Stacks[new_tcb_index][STACKSIZE-2] = (int32_t)(task);
-	if (tcbs_all_empty()){ // no threads added yet
-		RunPt = &tcbs[new_tcb_index]; // this thread runs first
+	tcbs[new_tcb_index].blocked = 0;
+	tcbs[new_tcb_index].adc_done.Value = 0;
+	SetInitialPC(Stacks[new_tcb_index], task);
+	tcbs[new_tcb_index].active = true;
+	if (first){ // no threads added yet
 		tcbs[new_tcb_index].next = &tcbs[new_tcb_index];  // points to self
+		if (IdleRunning){
+			IdleTcb.next = &tcbs[new_tcb_index]; // run it when idle is preempted
+		} else {
+			RunPt = &tcbs[new_tcb_index]; // this thread runs first
+		}
 	} else { // insert after current running thread
-		tcbs[new_tcb_index].next = RunPt->next;  // new thread points to next
-		RunPt->next = &tcbs[new_tcb_index];  // current thread points to new
+		tcbType *at = IdleRunning ? IdleTcb.next : RunPt;  // idle is not in ring
+		tcbs[new_tcb_index].next = at->next;  // new thread points to next
+		at->next = &tcbs[new_tcb_index];  // current thread points to new
 	}
 	tcbs[new_tcb_index].priority = priority;
   EndCritical(status);
@@ -263,13 +596,28 @@ bool OS_AddThread(void(*task)(void), uint16_t priority){
 // Inputs: number of 20ns clock cycles for each time slice
 //         (maximum of 24 bits)
 // Outputs: none (does not return)
+bool OS_AddPeriodicThread(void(*task)(void), uint32_t period, uint16_t priority);
 void OS_Launch(uint32_t theTimeSlice){
 	OS_ISR_period = theTimeSlice;
+#define OS_PERIODIC(task, period, pri) OS_AddPeriodicThread(&task, period, pri);
+	OS_CONFIG_PERIODIC
+#undef OS_PERIODIC
+	if (tcbs_all_empty()){
+		IdleTcb.next = &IdleTcb;
+		RunPt = &IdleTcb;          // nothing to do but idle
+		IdleRunning = true;
+		IdleStart = OS_Time();
+	}
 	if (preemptive_mode){
 		SysTick_Init(OS_ISR_period, OS_ISR_priority);	
   }
+	OS_MPU_SetGuard(RunPt);
 	OS_EnableInterrupts();
-	StartOS();                   // start on the first task
+	if (preemptive_mode){
+		StartOS();                 // start on the first task
+	} else {
+		StartOSCoop();             // cooperative stack frames
+	}
 }
 								 
 /********* OS_Sleep ****************
@@ -278,15 +626,44 @@ thread as sleeping for clock cycles
 passed in as argument, then suspend
 ***********************************/
 void OS_Sleep(uint64_t time){
+	if(OS_Unprivileged()){
+		SVC_Sleep(time);
+		return;
+	}
 	RunPt->sleep_start = OS_Time();
 	RunPt->sleep_time = time;
 	OS_Suspend();
 }
 
-void OS_CheckSleep(){
-	while(OS_TimeDifference(RunPt->sleep_start, OS_Time()) < RunPt->sleep_time){
-		RunPt = RunPt->next;
+/******** OS_CheckSleep ************
+Scheduler, called with RunPt already
+advanced to the next thread in the ring.
+Skips killed, sleeping and blocked threads.
+If a full lap finds nothing runnable,
+switch to the idle thread.
+***********************************/
+RAMFUNC void OS_CheckSleep(){
+	unsigned long now = OS_Time();
+	tcbType *start;
+	if(IdleRunning){           // leaving idle, RunPt = IdleTcb.next
+		IdleTime += now - IdleStart;
+		IdleRunning = false;
 	}
+	start = RunPt;
+	do{
+		if(RunPt != &IdleTcb && !tcb_is_empty(*RunPt) &&
+			 OS_TimeDifference(RunPt->sleep_start, now) >= RunPt->sleep_time &&
+			 (RunPt->blocked == 0 || RunPt->blocked->Value > 0)){
+			OS_MPU_SetGuard(RunPt);
+			return;                // runnable
+		}
+		RunPt = RunPt->next;
+	}while(RunPt != start);
+	IdleTcb.next = start;      // resume the search here after idle
+	IdleStart = now;
+	IdleRunning = true;
+	RunPt = &IdleTcb;
+	OS_MPU_SetGuard(RunPt);
 }
 
 /******** OS_Kill ******************
@@ -295,6 +672,10 @@ running threads
 ***********************************/
 void OS_Kill(){
 	int32_t status;
+	if(OS_Unprivileged()){
+		SVC_Kill();            // does not return
+		return;
+	}
   status = StartCritical();
 	tcbType *prev;  // search for what points to me
 	for (uint16_t i = 0; i < NUMTHREADS; i++){
@@ -311,9 +692,12 @@ void OS_Kill(){
 }
 
 bool OS_AddPeriodicThread(void(*task) (void),
-													uint64_t period,
+													uint32_t period,
 												  uint16_t priority){
   int16_t timer_to_use = -1;
+	if(OS_Unprivileged()){   // timer and NVIC registers are privileged
+		return SVC_AddPeriodicThread(task, period, priority);
+	}
 	 // Hacking to free up two timers for our own usage  
 	for (int16_t i = 1; i < sizeof(timer_occupied); i++){
 		if(!timer_occupied[i]){
@@ -375,6 +759,9 @@ int OS_AddSW2Task(void(*task)(void), unsigned long priority){
 //    e.g., 4 to 64 elements
 //    e.g., must be a power of 2,4,8,16,32,64,128
 void OS_Fifo_Init(unsigned long size) {
+	if(size > OS_CONFIG_FIFOSIZE){
+		size = OS_CONFIG_FIFOSIZE;  // storage is fixed at compile time
+	}
 	OS_Fifo_Length = size;
 	OS_Fifo_First = 0;
 	OS_Fifo_Last = 0;
@@ -504,6 +891,111 @@ unsigned long OS_MailBox_Recv(void) {
 	return data;
 }
 
+// frame channel, passes whole buffers by pointer from an ISR to
+// a foreground thread, nothing is copied
+static void *OS_Frames[OS_CONFIG_FRAMES];
+static volatile uint32_t OS_FramePut;
+static volatile uint32_t OS_FrameGet;
+
+// ******** OS_Frame_Put ************
+// send a full buffer to the frame channel
+// Called from the background, so no waiting
+// Inputs:  pointer to the buffer, usually a MemPool block
+// Outputs: 1 if sent, 0 if the channel is full and the
+//          caller still owns the buffer
+int OS_Frame_Put(void *frame) {
+	int32_t status;
+	status = StartCritical();
+	if(OS_FramePut - OS_FrameGet >= OS_CONFIG_FRAMES) {
+		EndCritical(status);
+		return 0;
+	}
+	OS_Frames[OS_FramePut&(OS_CONFIG_FRAMES-1)] = frame;
+	OS_FramePut++;
+	EndCritical(status);
+	OS_Signal(&FramesAvailable);
+	return 1;
+}
+
+// ******** OS_Frame_Get ************
+// receive the oldest buffer from the frame channel
+// Called in foreground, will block if empty
+// Inputs:  none
+// Outputs: pointer to the buffer, the caller now owns it,
+//          e.g., must MemPool_Free it when done
+// The thread is unprivileged, so two getters are kept apart with
+// LDREX/STREX rather than by masking interrupts
+void *OS_Frame_Get(void) {
+	uint32_t get;
+	void *frame;
+	OS_Wait(&FramesAvailable);
+	do {
+		get = __ldrex(&OS_FrameGet);
+		frame = OS_Frames[get&(OS_CONFIG_FRAMES-1)];
+	} while(__strex(get+1, &OS_FrameGet));
+	return frame;
+}
+
+// ******** OS_ADC_Collect ************
+// ADC_Collect for a thread, the burst signals only the thread that
+// queued it, so threads sharing ADC1 never wake for each other's
+// bursts or read a buffer that is still filling
+// Unprivileged threads reach this through SVC
+// Inputs:  as ADC_Collect
+// Outputs: as ADC_Collect
+int OS_ADC_Collect(uint32_t channelNum, uint32_t fs, uint16_t *buffer, uint32_t numberOfSamples) {
+	int32_t status;
+	int result;
+	uint32_t put;
+	if(OS_Unprivileged()){
+		return SVC_ADCCollect(channelNum, fs, buffer, numberOfSamples);
+	}
+	status = StartCritical();   // entry is in place before the burst can finish
+	if(ADCWaitPut - ADCWaitGet >= OS_ADCWAITERS) {
+		EndCritical(status);
+		return 0;
+	}
+	result = ADC_Collect(channelNum, fs, buffer, numberOfSamples);
+	if(result) {
+		put = ADCWaitPut&(OS_ADCWAITERS-1);
+		ADCWaitBuf[put] = buffer;
+		ADCWaitSema[put] = &RunPt->adc_done;
+		ADCWaitPut++;
+	}
+	EndCritical(status);
+	return result;
+}
+
+// ******** OS_ADC_Wait ************
+// sleep until the oldest burst this thread queued with
+// OS_ADC_Collect is done
+// A thread that queued n bursts calls this n times
+// Called in foreground, will block
+// Inputs:  none
+// Outputs: none
+void OS_ADC_Wait(void) {
+	OS_Wait(&RunPt->adc_done);
+}
+
+// ******** OS_ADC_WaitAlarm ************
+// sleep until at least one ADC digital comparator has fired
+// Called in foreground, will block
+// Inputs:  none
+// Outputs: bit n set for each comparator n that fired
+// The thread is unprivileged and can not mask interrupts, so the
+// bits are swapped out with LDREX/STREX, an alarm that lands between
+// the two makes the STREX fail and the swap is tried again
+uint32_t OS_ADC_WaitAlarm(void) {
+	uint32_t comps;
+	do {
+		OS_bWait(&ADCAlarm);
+		do {
+			comps = __ldrex(&ADCAlarms);
+		} while(__strex(0, &ADCAlarms));
+	} while(comps == 0);        // already taken by the previous call
+	return comps;
+}
+
 // ******** OS_Time ************
 // return the system time 
 // Inputs:  none
@@ -511,7 +1003,7 @@ unsigned long OS_MailBox_Recv(void) {
 // The time resolution should be less than or equal to 1us, and the precision 32 bits
 // It is ok to change the resolution and precision of this function as long as 
 //   this function and OS_TimeDifference have the same resolution and precision 
-unsigned long OS_Time(void) {
+RAMFUNC unsigned long OS_Time(void) {
 	return OS_Clock_Time * OS_Clock_Period + (OS_Clock_Period - TIMER2_TAV_R);
 }
 
@@ -526,17 +1018,46 @@ unsigned long OS_TimeDifference(unsigned long start, unsigned long stop) {
 	return (stop - start); // If we get two times that were gotten from OS_Time then we shouldn't have to convert anything
 }
 
+// ******** OS_PeriodicTime ************
+// OS_Time at which the timer running the current periodic thread
+// fired, from the count the timer has made since, so the software
+// latency to get here is not in it
+// Call from the periodic thread itself, within one period
+// Inputs:  none
+// Outputs: time in 12.5ns units, OS_Time() outside a periodic thread
+RAMFUNC unsigned long OS_PeriodicTime(void) {
+	int32_t status;
+	unsigned long now;
+	uint32_t load, count;
+	status = StartCritical();
+	now = OS_Time();
+	switch(OS_InISR()){         // exception number of the timer
+		case 37: load = TIMER1_TAILR_R; count = TIMER1_TAV_R; break;  // Timer1A
+		case 51: load = TIMER3_TAILR_R; count = TIMER3_TAV_R; break;  // Timer3A
+		default: load = count = 0; break;
+	}
+	EndCritical(status);
+	return now - (load - count);  // down counter, reloads at the timeout
+}
+
 /********** OS_Wait ************
 WARNING: CANNOT BE CALLED WHEN 
 INTERRUPTS ARE DISABLED!!!
 *******************************/
+int OS_TryWait(Sema4Type *s);
 void OS_Wait(Sema4Type *s){
+	if(OS_Unprivileged()){     // can not mask interrupts, let the kernel do it
+		while(SVC_TryWait(s) == 0){}
+		return;
+	}
 	OS_DisableInterrupts();
 	while(s->Value <= 0){
+		RunPt->blocked = s;  // scheduler skips us until s->Value > 0
 		OS_EnableInterrupts();
 		OS_Suspend();  // other task runs here
 		OS_DisableInterrupts();
 	}
+	RunPt->blocked = 0;
 	// see lecture 5 for
 	// blocking implementation pseudocode
 	s->Value = s->Value - 1;  // mark resource allocated
@@ -548,6 +1069,10 @@ void OS_Signal(Sema4Type *s){
 	// see lecture 5 for
 	// blocking implementation pseudocode
 	long status;
+	if(OS_Unprivileged()){
+		SVC_Signal(s);
+		return;
+	}
 	status = StartCritical();
 	s->Value = s->Value + 1;  // free resource
 	EndCritical(status);
@@ -561,13 +1086,20 @@ void OS_Signal(Sema4Type *s){
  WARNING: CANNOT BE CALLED WHEN 
 INTERRUPTS ARE DISABLED!!! 
 *******************************/
+int OS_TrybWait(Sema4Type *semaPt);
 void OS_bWait(Sema4Type *semaPt){
+	if(OS_Unprivileged()){     // can not mask interrupts, let the kernel do it
+		while(SVC_TrybWait(semaPt) == 0){}
+		return;
+	}
 	OS_DisableInterrupts();
 	while(!semaPt->Value){
+		RunPt->blocked = semaPt;  // scheduler skips us until Value > 0
 		OS_EnableInterrupts();
 		OS_Suspend();  // other task runs here
 		OS_DisableInterrupts();
 	}
+	RunPt->blocked = 0;
 	semaPt->Value = 0;
 	OS_EnableInterrupts();	
 }
@@ -578,13 +1110,254 @@ void OS_bWait(Sema4Type *semaPt){
 // output: none
 void OS_bSignal(Sema4Type *semaPt){
 	long status;
+	if(OS_Unprivileged()){
+		SVC_bSignal(semaPt);
+		return;
+	}
 	status = StartCritical();
 	semaPt->Value = 1;  // free resource
 	EndCritical(status);
 }	
 
+// ******** OS_TryWait ************
+// kernel half of OS_Wait for unprivileged threads, runs in SVC_Handler
+// takes the semaphore if it is free, otherwise marks the caller
+// blocked on it and pends a thread switch
+// input:  pointer to a counting semaphore
+// output: 1 if the semaphore was taken, 0 if the caller must retry
+int OS_TryWait(Sema4Type *s){
+	long status;
+	status = StartCritical();
+	if(s->Value > 0){
+		s->Value = s->Value - 1;  // mark resource allocated
+		RunPt->blocked = 0;
+		EndCritical(status);
+		return 1;
+	}
+	RunPt->blocked = s;  // scheduler skips us until s->Value > 0
+	EndCritical(status);
+	OS_Suspend();        // switch happens when SVC_Handler returns
+	return 0;
+}
+
+// ******** OS_TrybWait ************
+// kernel half of OS_bWait for unprivileged threads, runs in SVC_Handler
+// input:  pointer to a binary semaphore
+// output: 1 if the semaphore was taken, 0 if the caller must retry
+int OS_TrybWait(Sema4Type *semaPt){
+	long status;
+	status = StartCritical();
+	if(semaPt->Value > 0){
+		semaPt->Value = 0;
+		RunPt->blocked = 0;
+		EndCritical(status);
+		return 1;
+	}
+	RunPt->blocked = semaPt;
+	EndCritical(status);
+	OS_Suspend();
+	return 0;
+}
+
+// ******** OS_InitCondVar ************
+// no thread waiting
+// input:  pointer to a condition variable
+// output: none
+void OS_InitCondVar(CondVarType *cv){
+	OS_InitSemaphore(&cv->Sema, 0);
+	cv->Waiters = 0;
+}
+
+// ******** OS_CondWait ************
+// release the mutex, sleep until signaled, take the mutex again
+// Mesa semantics, the caller must recheck its condition in a loop
+// OS_Wait remembers a signal that arrives between the release and
+// the wait, so no wakeup is lost
+// input:  condition variable, binary semaphore held by the caller
+// output: none
+// WARNING: thread only, not from an ISR
+void OS_CondWait(CondVarType *cv, Sema4Type *mutex){
+	cv->Waiters = cv->Waiters + 1;
+	OS_bSignal(mutex);
+	OS_Wait(&cv->Sema);
+	OS_bWait(mutex);
+}
+
+// ******** OS_CondSignal ************
+// wake one thread in OS_CondWait, if any
+// input:  condition variable, its mutex must be held by the caller
+// output: none
+void OS_CondSignal(CondVarType *cv){
+	if(cv->Waiters > 0){
+		cv->Waiters = cv->Waiters - 1;
+		OS_Signal(&cv->Sema);
+	}
+}
+
+// ******** OS_CondBroadcast ************
+// wake every thread in OS_CondWait
+// input:  condition variable, its mutex must be held by the caller
+// output: none
+void OS_CondBroadcast(CondVarType *cv){
+	while(cv->Waiters > 0){
+		cv->Waiters = cv->Waiters - 1;
+		OS_Signal(&cv->Sema);
+	}
+}
+
+// ******** OS_InitRWLock ************
+// unlocked, no readers, no writers
+// input:  pointer to a reader-writer lock
+// output: none
+void OS_InitRWLock(RWLockType *rw){
+	OS_InitSemaphore(&rw->Mutex, 1);
+	OS_InitCondVar(&rw->ReadOK);
+	OS_InitCondVar(&rw->WriteOK);
+	rw->Readers = 0;
+	rw->Writer = 0;
+	rw->WaitingWriters = 0;
+}
+
+// ******** OS_ReadLock ************
+// shared access, waits while a writer holds or waits for the lock
+// input:  pointer to a reader-writer lock
+// output: none
+// WARNING: thread only, not from an ISR
+void OS_ReadLock(RWLockType *rw){
+	OS_bWait(&rw->Mutex);
+	while(rw->Writer || rw->WaitingWriters){
+		OS_CondWait(&rw->ReadOK, &rw->Mutex);
+	}
+	rw->Readers = rw->Readers + 1;
+	OS_bSignal(&rw->Mutex);
+}
+
+// ******** OS_ReadUnlock ************
+// the last reader out lets a waiting writer in
+// input:  pointer to a reader-writer lock
+// output: none
+void OS_ReadUnlock(RWLockType *rw){
+	OS_bWait(&rw->Mutex);
+	rw->Readers = rw->Readers - 1;
+	if(rw->Readers == 0){
+		OS_CondSignal(&rw->WriteOK);
+	}
+	OS_bSignal(&rw->Mutex);
+}
+
+// ******** OS_WriteLock ************
+// exclusive access, waits for current readers to drain
+// readers that arrive later queue behind this writer
+// input:  pointer to a reader-writer lock
+// output: none
+// WARNING: thread only, not from an ISR
+void OS_WriteLock(RWLockType *rw){
+	OS_bWait(&rw->Mutex);
+	rw->WaitingWriters = rw->WaitingWriters + 1;
+	while(rw->Writer || rw->Readers){
+		OS_CondWait(&rw->WriteOK, &rw->Mutex);
+	}
+	rw->WaitingWriters = rw->WaitingWriters - 1;
+	rw->Writer = 1;
+	OS_bSignal(&rw->Mutex);
+}
+
+// ******** OS_WriteUnlock ************
+// hand the lock to the next writer, or to all waiting readers
+// input:  pointer to a reader-writer lock
+// output: none
+void OS_WriteUnlock(RWLockType *rw){
+	OS_bWait(&rw->Mutex);
+	rw->Writer = 0;
+	if(rw->WaitingWriters){
+		OS_CondSignal(&rw->WriteOK);
+	} else{
+		OS_CondBroadcast(&rw->ReadOK);
+	}
+	OS_bSignal(&rw->Mutex);
+}
+
 int OS_Id(){
   return (int)RunPt;  // use pointer to tcb struct as id for now
 }
 
+//******** OS_FaultDump ***************
+// called by HardFault_Handler and MemManage_Handler in osasm.s
+// prints the faulting thread, fault status and stacked registers
+// on UART0 and halts. UART interrupts can not run at fault priority,
+// so this polls the hardware FIFO directly
+// Inputs: frame  the exception frame R0,R1,R2,R3,R12,LR,PC,xPSR
+//         excReturn  LR on entry to the fault handler
+static void Fault_OutChar(char data){
+	while((UART0_FR_R&UART_FR_TXFF) != 0){}
+	UART0_DR_R = data;
+}
+static void Fault_OutString(char *pt){
+	while(*pt){
+		Fault_OutChar(*pt);
+		pt++;
+	}
+}
+static void Fault_OutHex(char *name, uint32_t n){
+	Fault_OutString(name);
+	for(int32_t i = 28; i >= 0; i = i-4){
+		Fault_OutChar("0123456789ABCDEF"[(n>>i)&0x0F]);
+	}
+	Fault_OutString("\n\r");
+}
+void OS_FaultDump(uint32_t *frame, uint32_t excReturn){
+	uint32_t cfsr = NVIC_FAULT_STAT_R;
+	NVIC_MPU_CTRL_R = 0;      // the frame may sit in the guard itself
+	Fault_OutString("\n\r*** FAULT ***\n\r");
+	Fault_OutHex("IPSR  = ", OS_InISR());  // 3 HardFault, 4 MemManage
+	Fault_OutHex("CFSR  = ", cfsr);
+	Fault_OutHex("HFSR  = ", NVIC_HFAULT_STAT_R);
+	Fault_OutHex("MMFAR = ", NVIC_MM_ADDR_R);
+	if(excReturn&0x04){       // fault in a thread
+		if(RunPt == &IdleTcb){
+			Fault_OutString("thread idle\n\r");
+		} else{
+			Fault_OutHex("thread ", RunPt - tcbs);
+		}
+		Fault_OutHex("TCB   = ", (uint32_t)RunPt);
+		Fault_OutHex("stack = ", (uint32_t)RunPt->stack);
+	} else{
+		Fault_OutString("in handler or main, MSP\n\r");
+	}
+	if(cfsr&NVIC_FAULT_STAT_MSTKE){
+		Fault_OutString("stacking overflowed into the guard, frame below is partial\n\r");
+	}
+	Fault_OutHex("SP    = ", (uint32_t)frame);
+	Fault_OutHex("R0    = ", frame[0]);
+	Fault_OutHex("R1    = ", frame[1]);
+	Fault_OutHex("R2    = ", frame[2]);
+	Fault_OutHex("R3    = ", frame[3]);
+	Fault_OutHex("R12   = ", frame[4]);
+	Fault_OutHex("LR    = ", frame[5]);
+	Fault_OutHex("PC    = ", frame[6]);
+	Fault_OutHex("xPSR  = ", frame[7]);
+	for(;;){}                 // halt for the debugger
+}
+
+// kernel entry points for SVC_Handler in osasm.s, indexed by SVC number
+// SVC #0 starts the first thread and has no entry
+// order must match the SVC_ stubs in osasm.s, OS_SVC_COUNT entries
+int ADC_Init(unsigned int channelNum, uint32_t period, void(*task)(uint32_t hi));
+void (* const OS_SVCTable[])(void) = {
+	0,                                     // 0 StartOS
+	(void(*)(void))&OS_Suspend,            // 1
+	(void(*)(void))&OS_Sleep,              // 2
+	(void(*)(void))&OS_Kill,               // 3
+	(void(*)(void))&OS_AddThread,          // 4
+	(void(*)(void))&OS_AddPeriodicThread,  // 5
+	(void(*)(void))&OS_Signal,             // 6
+	(void(*)(void))&OS_bSignal,            // 7
+	(void(*)(void))&OS_TryWait,            // 8
+	(void(*)(void))&OS_TrybWait,           // 9
+	(void(*)(void))&ADC_Init,              // 10
+	(void(*)(void))&OS_ADC_Collect,        // 11
+	(void(*)(void))&ADC_Stop,              // 12
+	(void(*)(void))&ADC_ArmComparator      // 13
+};
+
 #endif
@@ -31,10 +31,35 @@
         EXTERN  RunPt            ; currently running thread
 		EXTERN  OS_Clock_Time
 		EXTERN  OS_CheckSleep
+		EXTERN  OS_SVCTable      ; kernel entry points, indexed by SVC number
+		EXTERN  __initial_sp     ; top of the MSP stack, in startup.s
+		EXTERN  OS_FaultDump
 		EXPORT  OS_DisableInterrupts
         EXPORT  OS_EnableInterrupts
         EXPORT  StartOS
+        EXPORT  StartOSCoop
         EXPORT  OS_ISR
+        EXPORT  OS_Yield
+        EXPORT  OS_InISR
+        EXPORT  OS_Unprivileged
+        EXPORT  SVC_Handler
+        EXPORT  HardFault_Handler
+        EXPORT  MemManage_Handler
+        EXPORT  SVC_Suspend
+        EXPORT  SVC_Sleep
+        EXPORT  SVC_Kill
+        EXPORT  SVC_AddThread
+        EXPORT  SVC_AddPeriodicThread
+        EXPORT  SVC_Signal
+        EXPORT  SVC_bSignal
+        EXPORT  SVC_TryWait
+        EXPORT  SVC_TrybWait
+        EXPORT  SVC_ADCInit
+        EXPORT  SVC_ADCCollect
+        EXPORT  SVC_ADCStop
+        EXPORT  SVC_ADCArmComparator
+
+OS_SVC_COUNT    EQU     14       ; must match OS_SVCTable in os.h
 		
 
 
@@ -48,40 +73,191 @@ OS_EnableInterrupts
         BX      LR
 
 
-OS_ISR		                   ; 1) Saves R0-R3,R12,LR,PC,PSR
+; returns the active exception number, 0 in thread mode
+OS_InISR
+        MRS     R0, IPSR
+        BX      LR
+
+
+; returns 1 if called from an unprivileged thread, which
+; must go through SVC to reach the kernel, 0 otherwise
+OS_Unprivileged
+        MRS     R0, IPSR
+        CBNZ    R0, Privileged     ; handlers are always privileged
+        MRS     R0, CONTROL
+        AND     R0, R0, #1         ; CONTROL.nPRIV
+        BX      LR
+Privileged
+        MOVS    R0, #0
+        BX      LR
+
+
+; The context switches run from SRAM, RW_RAMCODE in RTOS.sct,
+; away from flash wait states
+        AREA |.ramfunc|, CODE, READONLY, ALIGN=2
+        THUMB
+
+; Threads run in thread mode on PSP, the kernel and all ISRs on MSP.
+; The hardware stacks R0-R3,R12,LR,PC,PSR on the thread's PSP,
+; so nested ISRs never land on a thread stack.
+OS_ISR		                   ; 1) Saves R0-R3,R12,LR,PC,PSR on PSP
     CPSID   I                  ; 2) Prevent interrupt during switch
-    PUSH    {R4-R11}           ; 3) Save remaining regs r4-11
+    MRS     R0, PSP            ; 3) R0 = old thread stack
+    STMDB   R0!, {R4-R11}      ;    Save remaining regs r4-11 there
 	
-    LDR     R0, =RunPt         ; 4) R0=pointer to RunPt, old thread
-    LDR     R1, [R0]           ;    R1 = RunPt
-    STR     SP, [R1]           ; 5) Save SP into TCB
-    LDR     R1, [R1,#4]        ; 6) R1 = RunPt->next
-	STR     R1, [R0]           ;    RunPt = R1
+    LDR     R1, =RunPt         ; 4) R1=pointer to RunPt, old thread
+    LDR     R2, [R1]           ;    R2 = RunPt
+    STR     R0, [R2]           ; 5) Save PSP into TCB
+    LDR     R2, [R2,#4]        ; 6) R2 = RunPt->next
+	STR     R2, [R1]           ;    RunPt = R2
 
-	PUSH 	{R0-R4, LR}
+	PUSH 	{R1, LR}           ;    on MSP, LR is EXC_RETURN
 	BL OS_CheckSleep
-	POP		{R0-R4, LR}
+	POP		{R1, LR}
 	
-	LDR     R0, =RunPt         ; 4) R0=pointer to RunPt, old thread
-    LDR     R1, [R0]           ;    R1 = RunPt
-    
-	LDR     SP, [R1]           ; 7) new thread SP; SP = RunPt->sp;
-    POP     {R4-R11}           ; 8) restore regs r4-11
+    LDR     R2, [R1]           ;    R2 = RunPt, new thread
+	LDR     R0, [R2]           ; 7) new thread SP; R0 = RunPt->sp;
+    LDMIA   R0!, {R4-R11}      ; 8) restore regs r4-11
+    MSR     PSP, R0            ;    hardware pops the rest from PSP
     CPSIE   I                  ; 9) tasks run with interrupts enabled
     BX      LR                 ; 10) restore R0-R3,R12,LR,PC,PSR
 
-StartOS
+; Cooperative context switch, called as a function from a thread.
+; The caller already saved R0-R3,R12 per the AAPCS, so only the
+; callee-saved registers and the return address go on the stack,
+; with the caller's PRIMASK, which also keeps the stack 8-byte aligned
+; for the C call.  A thread that yields inside a critical section
+; gets its interrupts back disabled.
+; Frame, low to high: PRIMASK,R4-R11,LR  (10 words)
+OS_Yield
+    MRS     R2, PRIMASK        ; 1) caller's interrupt state
+    CPSID   I                  ;    Prevent interrupt during switch
+    PUSH    {R2, R4-R11, LR}   ; 2) Save it, callee-saved regs and return address
+    LDR     R0, =RunPt         ; 3) R0=pointer to RunPt, old thread
+    LDR     R1, [R0]           ;    R1 = RunPt
+    STR     SP, [R1]           ; 4) Save SP into TCB
+    LDR     R1, [R1,#4]        ; 5) R1 = RunPt->next
+    STR     R1, [R0]           ;    RunPt = R1
+    BL      OS_CheckSleep      ; 6) skip sleeping/blocked threads
+    LDR     R0, =RunPt
+    LDR     R1, [R0]           ;    R1 = RunPt
+    LDR     SP, [R1]           ; 7) new thread SP; SP = RunPt->sp;
+    POP     {R2, R4-R11, LR}   ; 8) restore regs and return address
+    MSR     PRIMASK, R2        ; 9) new thread's interrupt state, 0 at its start
+    BX      LR                 ; 10) return into the new thread
+    LTORG                      ; literals stay in SRAM with the code
+
+        AREA |.text|, CODE, READONLY, ALIGN=2
+        THUMB
+
+; Cooperative threads run privileged on PSP, so OS_Yield can
+; still mask interrupts while it switches
+StartOSCoop
     LDR     R0, =RunPt         ; currently running thread
     LDR     R2, [R0]           ; R2 = value of RunPt
-    LDR     SP, [R2]           ; new thread SP; SP = RunPt->stackPointer;
-    POP     {R4-R11}           ; restore regs r4-11
-    POP     {R0-R3}            ; restore regs r0-3
-    POP     {R12}
-    POP     {LR}               ; discard LR from initial stack
-    POP     {LR}               ; start location
-    POP     {R1}               ; discard PSR
+    LDR     R2, [R2]           ; new thread SP; R2 = RunPt->stackPointer;
+    MSR     PSP, R2
+    LDR     R0, =__initial_sp  ; give the kernel stack back its full size
+    MSR     MSP, R0
+    MOVS    R0, #2             ; CONTROL.SPSEL=1, privileged
+    MSR     CONTROL, R0
+    ISB
+    POP     {R2, R4-R11, LR}   ; restore regs from PSP, LR = start location
     CPSIE   I                  ; Enable interrupts at processor level
     BX      LR                 ; start first thread
+
+; Preemptive threads run unprivileged on PSP, started by SVC #0
+StartOS
+    LDR     R0, =RunPt         ; currently running thread
+    LDR     R2, [R0]           ; R2 = value of RunPt
+    LDR     R2, [R2]           ; new thread SP; R2 = RunPt->stackPointer;
+    LDMIA   R2!, {R4-R11}      ; restore regs r4-11
+    MSR     PSP, R2            ; PSP -> initial R0-R3,R12,LR,PC,PSR
+    LDR     R0, =__initial_sp  ; give the kernel stack back its full size
+    MSR     MSP, R0
+    CPSIE   I                  ; SVC with interrupts masked is a HardFault
+    SVC     #0                 ; exception return pops the first thread
+
+; SVC #0 starts the first thread, SVC #n calls OS_SVCTable[n]
+; with the caller's R0-R3 and returns its R0 in the caller's frame
+SVC_Handler
+    TST     LR, #4             ; which stack holds the caller's frame
+    ITE     EQ
+    MRSEQ   R0, MSP
+    MRSNE   R0, PSP
+    LDR     R1, [R0,#24]       ; stacked PC, just past the SVC
+    LDRB    R1, [R1,#-2]       ; SVC number from the instruction
+    CBZ     R1, SVC_Start
+    CMP     R1, #OS_SVC_COUNT
+    BHS     SVC_Done           ; unknown number, ignore
+    PUSH    {R0, LR}           ; frame pointer and EXC_RETURN, on MSP
+    LDR     R2, =OS_SVCTable
+    LDR     R12, [R2, R1, LSL #2]
+    LDM     R0, {R0-R3}        ; caller's arguments
+    BLX     R12
+    POP     {R1, LR}
+    STR     R0, [R1]           ; result into caller's R0
+SVC_Done
+    BX      LR
+SVC_Start
+    MOVS    R0, #1             ; CONTROL.nPRIV, threads are unprivileged
+    MSR     CONTROL, R0
+    ISB
+    LDR     LR, =0xFFFFFFFD    ; return to thread mode on PSP
+    BX      LR
+
+; Hand the faulting frame to OS_FaultDump in os.h, which prints it
+; on UART0 and halts.  R0 = stacked R0-R3,R12,LR,PC,xPSR, R1 = EXC_RETURN
+HardFault_Handler
+MemManage_Handler
+    TST     LR, #4             ; which stack holds the frame
+    ITE     EQ
+    MRSEQ   R0, MSP
+    MRSNE   R0, PSP
+    MOV     R1, LR
+    B       OS_FaultDump       ; does not return
+
+; Stubs that unprivileged threads call to enter the kernel,
+; arguments stay in R0-R3 and show up in the SVC frame
+SVC_Suspend
+    SVC     #1
+    BX      LR
+SVC_Sleep
+    SVC     #2
+    BX      LR
+SVC_Kill
+    SVC     #3
+    BX      LR
+SVC_AddThread
+    SVC     #4
+    BX      LR
+SVC_AddPeriodicThread
+    SVC     #5
+    BX      LR
+SVC_Signal
+    SVC     #6
+    BX      LR
+SVC_bSignal
+    SVC     #7
+    BX      LR
+SVC_TryWait
+    SVC     #8
+    BX      LR
+SVC_TrybWait
+    SVC     #9
+    BX      LR
+SVC_ADCInit
+    SVC     #10
+    BX      LR
+SVC_ADCCollect
+    SVC     #11
+    BX      LR
+SVC_ADCStop
+    SVC     #12
+    BX      LR
+SVC_ADCArmComparator
+    SVC     #13
+    BX      LR
 	
 	ALIGN
 	END
\ No newline at end of file
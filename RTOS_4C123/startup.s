@@ -613,12 +613,24 @@ EnableInterrupts
 
 ;*********** StartCritical ************************
 ; make a copy of previous I bit, disable interrupts
+; An unprivileged thread can not mask interrupts, its CPSID is
+; ignored, so rather than run the critical section unprotected
+; it faults into OS_FaultDump with the caller in the stacked LR.
+; Threads go through SVC or LDREX/STREX instead.
 ; inputs:  none
 ; outputs: previous I bit
 StartCritical
         MRS    R0, PRIMASK  ; save old status
         CPSID  I            ; mask all (except faults)
+        MRS    R1, IPSR     ; handlers are always privileged
+        CBNZ   R1, StartCriticalDone
+        MRS    R1, CONTROL
+        LSLS   R1, R1, #31  ; CONTROL.nPRIV
+        BNE    StartCriticalFault
+StartCriticalDone
         BX     LR
+StartCriticalFault
+        UDF    #0           ; UsageFault, escalates to HardFault
 
 ;*********** EndCritical ************************
 ; using the copy of previous I bit, restore I bit to previous value
@@ -0,0 +1,123 @@
+// BiquadDesign.c
+// Runs on the host PC, not the LM4F120/TM4C123
+// Designs a cascade of biquad sections with the audio EQ cookbook
+// formulas and prints the coefficient table that Biquad.c expects,
+// ready to paste into the program.
+// EE445M Lab 2
+
+// build:  gcc -o BiquadDesign BiquadDesign.c -lm
+// usage:  BiquadDesign name q15|q31 fs type f0 Q [type f0 Q]...
+//         type is lowpass, highpass, bandpass or notch
+// e.g.,   BiquadDesign Notch60 q15 2000 notch 60 9.5
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// coefficients of one section, normalized so a0 is 1
+struct Section{
+  double b0, b1, b2, a1, a2;
+};
+
+static int Design(struct Section *s, const char *type, double f0, double fs, double q){
+  double w0 = 2.0*M_PI*f0/fs;
+  double c = cos(w0);
+  double alpha = sin(w0)/(2.0*q);
+  double a0 = 1.0 + alpha;
+  if(strcmp(type, "lowpass") == 0){
+    s->b0 = (1.0 - c)/2.0;
+    s->b1 = 1.0 - c;
+    s->b2 = (1.0 - c)/2.0;
+  } else if(strcmp(type, "highpass") == 0){
+    s->b0 = (1.0 + c)/2.0;
+    s->b1 = -(1.0 + c);
+    s->b2 = (1.0 + c)/2.0;
+  } else if(strcmp(type, "bandpass") == 0){  // 0 dB peak gain
+    s->b0 = alpha;
+    s->b1 = 0.0;
+    s->b2 = -alpha;
+  } else if(strcmp(type, "notch") == 0){
+    s->b0 = 1.0;
+    s->b1 = -2.0*c;
+    s->b2 = 1.0;
+  } else{
+    return 0;
+  }
+  s->b0 /= a0;
+  s->b1 /= a0;
+  s->b2 /= a0;
+  s->a1 = -2.0*c/a0;
+  s->a2 = (1.0 - alpha)/a0;
+  return 1;
+}
+
+// round to a fixed-point integer with frac bits, 0 if out of range
+static int Fixed(double x, int frac, int bits, int32_t *out){
+  double v = floor(x*(double)(1LL<<frac) + 0.5);
+  double max = (double)((1LL<<(bits-1)) - 1);
+  if((v > max) || (v < -max-1.0)){
+    return 0;
+  }
+  *out = (int32_t)v;
+  return 1;
+}
+
+int main(int argc, char **argv){
+  struct Section s;
+  int32_t b0, b1, b2, a1, a2;
+  int q31, stages, i, ok;
+  double fs;
+  if((argc < 7) || ((argc-4)%3 != 0)){
+    fprintf(stderr, "usage: %s name q15|q31 fs type f0 Q [type f0 Q]...\n", argv[0]);
+    return 1;
+  }
+  q31 = (strcmp(argv[2], "q31") == 0);
+  fs = atof(argv[3]);
+  stages = (argc-4)/3;
+  printf("// %s, %d section%s at fs = %s Hz, from tools/BiquadDesign\n",
+         argv[1], stages, (stages > 1) ? "s" : "", argv[3]);
+  printf("#define %s_STAGES %d\n", argv[1], stages);
+  if(q31){
+    printf("const int32_t %s[BIQUAD_Q31_COEFFS*%s_STAGES] = {\n", argv[1], argv[1]);
+  } else{
+    printf("const int32_t %s[BIQUAD_Q15_COEFFS*%s_STAGES] = {\n", argv[1], argv[1]);
+  }
+  for(i = 0; i < stages; i++){
+    const char *type = argv[4+3*i];
+    double f0 = atof(argv[5+3*i]);
+    double q = atof(argv[6+3*i]);
+    if((f0 <= 0.0) || (f0 >= fs/2.0) || (q <= 0.0) || !Design(&s, type, f0, fs, q)){
+      fprintf(stderr, "bad section %s %s %s\n", type, argv[5+3*i], argv[6+3*i]);
+      return 1;
+    }
+    if(q31){  // Q2.30, five words, feedback negated
+      ok = Fixed(s.b0, 30, 32, &b0) && Fixed(s.b1, 30, 32, &b1) && Fixed(s.b2, 30, 32, &b2) &&
+           Fixed(-s.a1, 30, 32, &a1) && Fixed(-s.a2, 30, 32, &a2);
+      if(!ok){
+        fprintf(stderr, "section %d does not fit in Q2.30\n", i);
+        return 1;
+      }
+      printf("  %d, %d, %d, %d, %d,  // %s %s Hz Q %s\n",
+             b0, b1, b2, a1, a2, type, argv[5+3*i], argv[6+3*i]);
+    } else{   // Q2.14, b0 then b2:b1 and -a2:-a1 packed for SMLAD
+      ok = Fixed(s.b0, 14, 16, &b0) && Fixed(s.b1, 14, 16, &b1) && Fixed(s.b2, 14, 16, &b2) &&
+           Fixed(-s.a1, 14, 16, &a1) && Fixed(-s.a2, 14, 16, &a2);
+      if(!ok){
+        fprintf(stderr, "section %d does not fit in Q2.14\n", i);
+        return 1;
+      }
+      printf("  %d, 0x%08X, 0x%08X,  // %s %s Hz Q %s\n", b0,
+             (uint32_t)(((uint32_t)b2<<16)|((uint32_t)b1&0xFFFF)),
+             (uint32_t)(((uint32_t)a2<<16)|((uint32_t)a1&0xFFFF)),
+             type, argv[5+3*i], argv[6+3*i]);
+    }
+  }
+  printf("};\n");
+  return 0;
+}
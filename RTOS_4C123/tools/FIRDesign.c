@@ -0,0 +1,60 @@
+// FIRDesign.c
+// Runs on the host PC, not the LM4F120/TM4C123
+// Designs a linear-phase lowpass FIR by the window method, a
+// Hamming windowed sinc, and prints the Q15 taps for FIR.c
+// EE445M Lab 2
+
+// build:  gcc -o FIRDesign FIRDesign.c -lm
+// usage:  FIRDesign name taps fs fc [gain]
+//         gain is the passband gain, the interpolation factor
+//         for FIR_Q15InitInterpolate, default 1
+// e.g.,   FIRDesign Lowpass64 64 8000 800
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+int main(int argc, char **argv){
+  int taps, i;
+  double fs, fc, gain, sum, t, w, v;
+  double *h;
+  if((argc < 5) || (argc > 6)){
+    fprintf(stderr, "usage: %s name taps fs fc [gain]\n", argv[0]);
+    return 1;
+  }
+  taps = atoi(argv[2]);
+  fs = atof(argv[3]);
+  fc = atof(argv[4]);
+  gain = (argc == 6) ? atof(argv[5]) : 1.0;
+  if((taps < 2) || (taps&1) || (fc <= 0.0) || (fc >= fs/2.0)){
+    fprintf(stderr, "taps must be even, 0 < fc < fs/2\n");
+    return 1;
+  }
+  h = malloc(taps*sizeof(double));
+  sum = 0.0;
+  for(i = 0; i < taps; i++){
+    t = i - (taps-1)/2.0;                       // symmetric about the middle
+    w = 0.54 - 0.46*cos(2.0*M_PI*i/(taps-1));   // Hamming
+    h[i] = w*((t == 0.0) ? 2.0*fc/fs : sin(2.0*M_PI*fc*t/fs)/(M_PI*t));
+    sum += h[i];
+  }
+  printf("// %s, %d tap lowpass, fc = %s Hz at fs = %s Hz, from tools/FIRDesign\n",
+         argv[1], taps, argv[4], argv[3]);
+  printf("#define %s_TAPS %d\n", argv[1], taps);
+  printf("const int16_t %s[%s_TAPS] = {", argv[1], argv[1]);
+  for(i = 0; i < taps; i++){
+    v = floor(gain*h[i]/sum*32768.0 + 0.5);   // unity gain at DC, times gain
+    if((v > 32767.0) || (v < -32768.0)){
+      fprintf(stderr, "tap %d does not fit in Q15, lower the gain\n", i);
+      return 1;
+    }
+    printf("%s%d%s", (i%8) ? " " : "\n  ", (int)v, (i < taps-1) ? "," : "");
+  }
+  printf("\n};\n");
+  free(h);
+  return 0;
+}
@@ -0,0 +1,84 @@
+// FixMathTables.c
+// Runs on the host PC, not the LM4F120/TM4C123
+// Prints the lookup tables FixMath.c interpolates, ready to paste
+// into FixMath.c, so the target never needs floating point or libm.
+// EE445M Lab 2
+
+// build:  gcc -o FixMathTables FixMathTables.c -lm
+// usage:  FixMathTables > tables.txt
+// The sizes must match FIXMATH_SINSIZE, FIXMATH_LOGSIZE and
+// FIXMATH_CORDIC in FixMath.c.  It also prints the worst error of
+// linear interpolation between the entries, the bounds in FixMath.h.
+
+#include <stdio.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SINSIZE 256        // segments in a quarter wave
+#define LOGSIZE 256        // segments in one octave
+#define CORDIC  24         // CORDIC iterations
+#define SQRTMIN 64         // first top byte of a normalized square root argument
+
+static void Print(const char *type, const char *name, int n, const long long *v){
+  int i;
+  printf("static const %s %s[%d] = {", type, name, n);
+  for(i = 0; i < n; i++){
+    printf("%s%lld%s", (i%6) ? " " : "\n  ", v[i], (i < n-1) ? "," : "");
+  }
+  printf("\n};\n");
+}
+
+int main(void){
+  long long v[SINSIZE+1];
+  double worst, x, y, e;
+  int i, j;
+  // sin(pi/2*i/SINSIZE) in Q30
+  for(i = 0; i <= SINSIZE; i++){
+    v[i] = llround(sin(M_PI/2*i/SINSIZE)*1073741824.0);
+  }
+  printf("// sin(pi/2*i/%d) in Q30, from tools/FixMathTables\n", SINSIZE);
+  Print("int32_t", "SinQuarter", SINSIZE+1, v);
+  worst = 0;
+  for(i = 0; i < SINSIZE; i++){
+    for(j = 0; j < 64; j++){
+      x = (i + j/64.0)/SINSIZE;
+      y = (v[i] + (v[i+1]-v[i])*j/64.0)/1073741824.0;
+      e = fabs(y - sin(M_PI/2*x));
+      if(e > worst) worst = e;
+    }
+  }
+  fprintf(stderr, "sin worst error %.3g\n", worst);
+  // 65536*log2(1+i/LOGSIZE)
+  for(i = 0; i <= LOGSIZE; i++){
+    v[i] = llround(log2(1.0 + (double)i/LOGSIZE)*65536.0);
+  }
+  printf("// log2(1+i/%d) in Q16, from tools/FixMathTables\n", LOGSIZE);
+  Print("uint32_t", "Log2Frac", LOGSIZE+1, v);
+  worst = 0;
+  for(i = 0; i < LOGSIZE; i++){
+    for(j = 0; j < 64; j++){
+      x = 1.0 + (i + j/64.0)/LOGSIZE;
+      y = (v[i] + (v[i+1]-v[i])*j/64.0)/65536.0;
+      e = fabs(y - log2(x));
+      if(e > worst) worst = e;
+    }
+  }
+  fprintf(stderr, "log2 worst error %.3g\n", worst);
+  // atan(2^-i) with 2^32 per turn
+  for(i = 0; i < CORDIC; i++){
+    v[i] = llround(atan(ldexp(1.0, -i))/(2*M_PI)*4294967296.0);
+  }
+  printf("// atan(2^-i), 2^32 per turn, from tools/FixMathTables\n");
+  Print("int32_t", "AtanTable", CORDIC, v);
+  // square root guess for a normalized argument with top byte i,
+  // at the middle of the range, sqrt((i+0.5)*2^24)
+  for(i = SQRTMIN; i < 256; i++){
+    v[i-SQRTMIN] = llround(sqrt((i + 0.5)*16777216.0));
+  }
+  printf("// sqrt((i+0.5)*2^24) for top bytes i = %d to 255, from tools/FixMathTables\n", SQRTMIN);
+  Print("uint16_t", "SqrtGuess", 256-SQRTMIN, v);
+  return 0;
+}